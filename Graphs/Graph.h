@@ -2,10 +2,33 @@
 #include <iostream>
 #include <vector>
 #include <queue>
+#include <deque>
+#include <map>
 #include <unordered_set>
 #include <unordered_map>
 #include <sstream>
 #include <fstream>
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <tuple>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using std::string;
 using std::vector;
@@ -17,6 +40,16 @@ using std::unordered_set;
 #define ACTIVE       'a'
 #define FINISHED     'f'
 
+#define GRAPH_FILE_MAGIC       "GRAPHCSR"
+#define GRAPH_FILE_VERSION     1
+#define GRAPH_FILE_BYTE_ORDER  0x01020304
+
+#define ALT_FILE_MAGIC         "GRAPHALT"
+#define ALT_FILE_VERSION       1
+
+#define CH_FILE_MAGIC          "GRAPH_CH"
+#define CH_FILE_VERSION        1
+
 /*
  * function:  pvec
  * description:  utility function that prints the elements of
@@ -37,1152 +70,7631 @@ void pvec(const std::vector<T> & vec) {
 
 
 /*
- * class:  graph
+ * class:  edge_set
  *
- * desc:   class for representing directed graphs.  Uses the
- *   adjacency list representation.
- *
- * key concepts:
+ * desc:   set of directed edges (s_id, d_id) given as integer vertex
+ *   IDs.  Used by the graph class to detect duplicate edges.
  *
- *   - Each vertex is identified by a string AND by an integer ID:
- *       o strings are convenient for the outside world -- we can 
- *         give vertices meaningful real-world names like Chicago
- *         and Peoria
- *       o On the other hand, refering to vertices with simple integer IDs
- *           0..|V|-1 is convenient and efficient for algorithm 
- *           implementation of many algorithms.
+ *   Each edge is packed into a single 64-bit key
  *
- *       ref:  see the read_file function (which reads edges as string pairs).
+ *       (s_id << 32) | d_id
  *
- *   - mapping between vertex names and vertex-IDs:
- *       the graph class has a data member called _name2id which is an 
- *       unordered map from strings (vertex names) to integers (corresponding
- *       vertex ID).
+ *   and stored in an open-addressing hash table (linear probing).
+ *   There are no per-entry heap allocations:  the table is one flat
+ *   array of keys, kept at most 70% full, so an edge costs about
+ *   11-16 bytes.
+ */
+class edge_set {
+
+  private:
+    // IDs are non-negative ints, so no real key has all bits set
+    static const uint64_t EMPTY = ~(uint64_t)0;
+
+    vector<uint64_t> table;
+    size_t count;
+    size_t mask;
+
+    static uint64_t pack(int s_id, int d_id) {
+      return ((uint64_t)(uint32_t)s_id << 32) | (uint32_t)d_id;
+    }
+
+    // 64-bit mixer (murmur3 finalizer) so that consecutive IDs
+    //   spread over the table
+    static size_t hash(uint64_t k) {
+      k ^= k >> 33;
+      k *= 0xff51afd7ed558ccdULL;
+      k ^= k >> 33;
+      k *= 0xc4ceb9fe1a85ec53ULL;
+      k ^= k >> 33;
+      return (size_t)k;
+    }
+
+    void grow() {
+      vector<uint64_t> old;
+      old.swap(table);
+      table.assign(old.empty() ? 16 : 2*old.size(), (uint64_t)EMPTY);
+      mask = table.size() - 1;
+      for(uint64_t k : old) {
+        if(k != EMPTY) {
+          size_t i = hash(k) & mask;
+          while(table[i] != EMPTY)
+            i = (i+1) & mask;
+          table[i] = k;
+        }
+      }
+    }
+
+  public:
+    edge_set() : count { 0 }, mask { 0 } { }
+
+    /*
+     * inserts edge (s_id, d_id).  Returns true if the edge is new,
+     *   false if it was already in the set.
+     */
+    bool insert(int s_id, int d_id) {
+      uint64_t k = pack(s_id, d_id);
+      size_t i;
+
+      if(10*(count+1) > 7*table.size())
+        grow();
+      for(i = hash(k) & mask; table[i] != EMPTY; i = (i+1) & mask) {
+        if(table[i] == k)
+          return false;
+      }
+      table[i] = k;
+      count++;
+      return true;
+    }
+
+    bool contains(int s_id, int d_id) const {
+      uint64_t k = pack(s_id, d_id);
+      size_t i;
+
+      if(table.empty())
+        return false;
+      for(i = hash(k) & mask; table[i] != EMPTY; i = (i+1) & mask) {
+        if(table[i] == k)
+          return true;
+      }
+      return false;
+    }
+
+    /*
+     * removes edge (s_id, d_id).  Returns false if it was not in the
+     *   set.  No tombstone is left behind:  the keys after it in its
+     *   probe run are shifted back into the hole, unless that would
+     *   move one in front of its own home slot.
+     */
+    bool erase(int s_id, int d_id) {
+      uint64_t k = pack(s_id, d_id);
+      size_t i, j, home;
+
+      if(table.empty())
+        return false;
+      for(i = hash(k) & mask; table[i] != k; i = (i+1) & mask) {
+        if(table[i] == EMPTY)
+          return false;
+      }
+      for(j = (i+1) & mask; table[j] != EMPTY; j = (j+1) & mask) {
+        home = hash(table[j]) & mask;
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+          table[i] = table[j];
+          i = j;
+        }
+      }
+      table[i] = EMPTY;
+      count--;
+      return true;
+    }
+
+    void reserve(size_t n) {
+      while(10*n > 7*table.size())
+        grow();
+    }
+
+    void clear() {
+      vector<uint64_t>().swap(table);
+      count = 0;
+      mask = 0;
+    }
+
+    size_t size() const {
+      return count;
+    }
+
+    size_t bytes() const {
+      return table.size() * sizeof(uint64_t);
+    }
+};
+
+
+/*
+ * class:  name_view
  *
- *   - Key data structures and types:
+ * desc:   read-only reference to a vertex name stored in a name_arena
+ *   (a pointer and a length, like C++17's std::string_view).  Returned
+ *   by graph::id2name so that looking up a name copies nothing.
  *
- *       vertices:  The graph class also contains a data member called vertices.
- *         It is the core of the adjacency list representation and is where most 
- *         of the action is!  It is a vector of type vertex.
- *         It is indexed by vertex ID.
+ *   It converts to a string where one is needed (e.g.,
+ *   string s = g.id2name(u)), concatenates with + and prints with <<.
  *
- *       vertex struct:  within a vertex struct there are four data members which
- *         capture what we need to know about a vertex:
+ *   A view is only valid until the next vertex is added to the graph:
+ *   the arena may move its characters when it grows.  Keep a string
+ *   copy if you need the name longer than that.
+ */
+class name_view {
+
+  private:
+    const char *p;
+    size_t len;
+
+  public:
+    name_view(const char *_p=NULL, size_t _len=0) : p { _p }, len { _len } { }
+
+    const char * data() const { return p; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const char * begin() const { return p; }
+    const char * end() const { return p+len; }
+    char operator[](size_t i) const { return p[i]; }
+
+    string str() const { return string(p, len); }
+    operator string() const { return str(); }
+
+    bool operator==(const name_view &o) const {
+      return len == o.len && memcmp(p, o.p, len) == 0;
+    }
+    bool operator!=(const name_view &o) const { return !(*this == o); }
+
+    friend std::ostream & operator<<(std::ostream &os, const name_view &v) {
+      return os.write(v.p, v.len);
+    }
+
+    // concatenation, as with strings
+    friend string operator+(const string &a, const name_view &b) {
+      return string(a).append(b.p, b.len);
+    }
+    friend string operator+(const name_view &a, const string &b) {
+      return a.str() + b;
+    }
+    friend string operator+(const char *a, const name_view &b) {
+      return string(a).append(b.p, b.len);
+    }
+    friend string operator+(const name_view &a, const char *b) {
+      return a.str() + b;
+    }
+};
+
+
+/*
+ * class:  name_arena
  *
- *              id:  integer id associated with vertex (not used very often...)
- *              incoming:  a vector of incoming edges (edges for which this
- *                  vertex is the destination vertex).  The edge struct is 
- *                  the element type of the vector (see below).
- *              outgoing:  a vector of outgoing edges (edges for which this
- *                  vertex is the source vertex).
- *              name:  the string name associated with the vertex.  This lets
- *                  us map from vertex ID to vertex name.
+ * desc:   the vertex names of a graph and the index from names to
+ *   vertex IDs.
  *
- *       edge struct:  this struct captures what we need to know about an edge
- *          in the context of an adjacency list representation.  There are two
- *          data members:
+ *   Every name is stored exactly once, back to back in one char
+ *   array; the name of vertex id is
  *
- *              vertex_id:  this is the id of the "other" vertex.  If 
- *                 an edge struct is part of a vector of outgoing edges, 
- *                 then vertex_id refers to the DESTINATION vertex of the edge;
- *                 if it is part of a vector of incoming edges, then
- *                 vertex_id refers to the SOURCE vertex of the edge.
- *              
- *              weight:  this is a floating point number giving the weight of
- *                 the edge.  It defaults to 1.0 and is not relevant for
- *                 all operations you might want to perform on a graph.
+ *       chars[start[id] .. start[id+1]-1]
  *
- *  ------------------------------------------------------------------
+ *   (which happens to be the layout of the names sections of the
+ *   binary graph format, so write_binary/read_binary copy them in
+ *   one piece).
  *
- *  The vertex_label struct:  When a graph algorithm (like bfs or dfs) is 
- *    run, it will often record its results via "labels" associated with the
- *    vertices.  Accordingly, we have a vertex_label structure for this purpose.
+ *   The index is an open-addressing hash table (linear probing, at
+ *   most 70% full) of 64-bit slots
  *
- *  A particular algorithm will populate a vector of vertex labels (where the
- *    vector is indexed by vertex id).  Some of the fields in the label struct
- *    may only be relevant for certain algorithms.  Take a look at bfs to get
- *    an idea of how an algorithm sets the labels of vertices.
+ *       (upper 32 bits of the name's hash << 32) | id
  *
- *  Note that a label is not part of the vertex struct itself, and a vector 
- *    of labels is not part of a graph instance.  This may seem strange at 
- *    first, but when you consider that, for example, on a particular graph, you might
- *    want to run bfs from some vertex A and also from some vertex B; by 
- *    separating the labels from the graph instance, we can keep the results of
- *    both of these runs.
+ *   so a probe compares characters only when the hash bits match.
  *
- *  Vocabulary:  a vector of labels populated by a particular algorithm is 
- *    typically referred to as a "report" (i.e., the algorithm reports its 
- *    results via such a vector).
- *  
+ *   A name costs its length plus about 20 bytes, instead of the two
+ *   std::string copies (one in the vertex, one as a hash map key) and
+ *   the hash map node of the old representation -- typically
+ *   100+ bytes and three heap blocks.
  */
-
-class graph {
+class name_arena {
 
   private:
+    static const uint64_t EMPTY = ~(uint64_t)0;
 
-    // note:  this struct does not store both
-    //   vertices in the edge -- just one.  This
-    //   is because of the overall structure of
-    //   the adjacency list organization:  an
-    //   edge struct is stored in a vector associated
-    //   with the other vertex.
-    struct edge {
-      int vertex_id;
-      double weight;
-      edge ( int vtx_id=0, double _weight=1.0) 
-        : vertex_id { vtx_id}, weight { _weight} 
-      { }
-    };
+    vector<char> chars;
+    vector<uint64_t> start;
+    vector<uint64_t> table;
+    size_t mask;
 
-    // a vertex struct stores all info about a particular
-    //    vertex:  name, ID, incoming and outgoing edges.
-    struct vertex {
-      int id;
-      vector<edge> outgoing;
-      vector<edge> incoming;
-      string name;
+    // FNV-1a
+    static uint64_t hash(const char *p, size_t len) {
+      uint64_t h = 0xcbf29ce484222325ULL;
+      size_t i;
 
-      vertex ( int _id=0, string _name="") 
-        : id { _id }, name { _name } 
-      { }
-    };
+      for(i=0; i<len; i++) {
+        h ^= (unsigned char)p[i];
+        h *= 0x100000001b3ULL;
+      }
+      return h ^ (h >> 29);
+    }
 
-    /**************************************************
-    *   Data members of the Graph class here!
-    *
-    *   Everything about a graph is accessible via
-    *    these three data structures!
-    ***************************************************/
+    static uint64_t slot(uint64_t h, int id) {
+      return (h & 0xffffffff00000000ULL) | (uint32_t)id;
+    }
 
-    // _name2id:
-    // Each vertex in a graph is identified in two ways:
-    //      - by its unique 'name' which is a string (so things are
-    //        friendly to the outside world).
-    //      - by its unique integer ID which is more convenient 
-    //        internally.  If a graph has N vertices, the 
-    //        corresponding IDs are ALWAYS 0..N-1.
-    // _name2id is an unordered_map (hash map) which lets us easily
-    //       retrieve the vertex ID associated with a given vertex
-    //       name (it maps from strings to integers).
-    unordered_map<string, int> _name2id;
+    bool matches(uint64_t s, uint64_t h, const char *p, size_t len) const {
+      int id = (uint32_t)s;
 
-    // vertices:
-    //   vertices is the primary data structure:  it is an  implementation
-    //      of a pretty standard adjacency list.
-    //   It is indexed by vertex ID.
-    //   vertices[u] contains everything we need to know about vertex u:
-    //       - name (string)
-    //       - ID (int).  Somewhat redundant since vertices[u].id == u
-    //       - outgoing edges (as a vector of edge structures)
-    //       - incoming edges (as a vector of edge structures)
-    //       
-    //   See struct vertex above
-    vector<vertex> vertices;
+      return (s >> 32) == (h >> 32) && start[id+1] - start[id] == len &&
+        memcmp(&chars[start[id]], p, len) == 0;
+    }
 
-    // the unordered set edges isn't going to be of much interest
-    //   to you.  Its main purpose is to detect duplicate edges
-    //   while building a graph (see add_edge)..
-    // Notes:  the data structure is an unordered_set which is
-    //   really a hash table.  It stores a unique string 
-    //   representation of already added edges; it allows add_edge
-    //   to detect if an edge already exists efficiently.
-    unordered_set<string> edges;
+    void place(int id) {
+      uint64_t h = hash(&chars[start[id]], start[id+1] - start[id]);
+      size_t i;
 
-  public:
+      for(i = h & mask; table[i] != EMPTY; i = (i+1) & mask)
+        ;
+      table[i] = slot(h, id);
+    }
 
-    // this struct is used for capturing the results of an operation.
-    // typically a "report" will be a vector of vertex_labels indexed
-    // by vertex-id.
-    struct vertex_label {
-      double dist; //distance
-      int pred; // predecessor 
-      char state;
-      int npaths;
-      
-      vertex_label( double _dist=0.0, int _pred=-1, char _state='?',
-          int _npaths=0) 
-        : dist { _dist }, pred { _pred }, state { _state}, npaths { 0 }
-      { }
+    void rehash(size_t nslots) {
+      int id;
 
-    };
+      table.assign(nslots, (uint64_t)EMPTY);
+      mask = nslots - 1;
+      for(id=0; id<size(); id++)
+        place(id);
+    }
 
+  public:
+    name_arena() : start(1, 0), mask { 0 } { }
 
-    graph() {}
+    int size() const {
+      return start.size() - 1;
+    }
 
-    ~graph() {}
+    name_view get(int id) const {
+      return name_view(chars.data() + start[id], start[id+1] - start[id]);
+    }
 
-  private:
+    // ID of the given name, or -1
+    int find(const char *p, size_t len) const {
+      uint64_t h = hash(p, len);
+      size_t i;
 
-    int add_vertex(const string &name) {
-      int id = vertices.size();
-        vertices.push_back(vertex(id, name));
-        _name2id[name] = id;
-        return id;
+      if(table.empty())
+        return -1;
+      for(i = h & mask; table[i] != EMPTY; i = (i+1) & mask) {
+        if(matches(table[i], h, p, len))
+          return (uint32_t)table[i];
+      }
+      return -1;
     }
 
     /*
-     * function:  edge_string
-     *
-     * returns concatenation of src and dest vertex strings with
-     * a single space between
-     *
-     * Purpos:  gives a unique string representing the edge
-     * -- data member edges stores sets of such strings to
-     * quickly detect if an edge has already been created.
-     *
+     * returns the ID of the given name, adding the name (as ID size())
+     *   first if it is not there yet.  added tells which.
      */
-    static
-    string edge_string(const string &src, const string &dest) {
-      return src + " " + dest;
+    int insert(const char *p, size_t len, bool &added) {
+      uint64_t h = hash(p, len);
+      size_t i;
+      int id = size();
+
+      if(10*(size_t)(id+1) > 7*table.size())
+        rehash(table.empty() ? 16 : 2*table.size());
+      for(i = h & mask; table[i] != EMPTY; i = (i+1) & mask) {
+        if(matches(table[i], h, p, len)) {
+          added = false;
+          return (uint32_t)table[i];
+        }
+      }
+      table[i] = slot(h, id);
+      chars.insert(chars.end(), p, p+len);
+      start.push_back(chars.size());
+      added = true;
+      return id;
     }
 
+    // room for n names with nchars characters in all
+    void reserve(int n, size_t nchars) {
+      size_t nslots = table.empty() ? 16 : table.size();
 
-    /*
-     * function: p_edge
-     * desc:  simple function for printing an edge
-     */
-    void p_edge(edge &e) {
-      std::cout << "(" << id2name(e.vertex_id) 
-        << ", " << e.weight << ") ";
+      chars.reserve(nchars);
+      start.reserve(n+1);
+      while(10*(size_t)n > 7*nslots)
+        nslots *= 2;
+      if(nslots != table.size())
+        rehash(nslots);
     }
 
-  public:
-
     /*
-     * func:  id2name
-     * desc:  returns vertex name (a string) associated with given 
-     *         vertex id.
-     *
-     *         If id not valid for given graph, the string "$NONE$"
-     *         is returned.
+     * replaces the contents with n names given in the arena layout
+     *   (see above).  Names must be distinct.
      */
-    string  id2name(int id) {
-      if(id<0 || id>=vertices.size())
-        return "$NONE$";
-      return vertices[id].name;
+    void assign(const char *p, const uint64_t *off, int n) {
+      chars.assign(p, p + off[n]);
+      start.assign(off, off + n+1);
+      table.clear();
+      reserve(n, 0);     // builds the index
     }
 
     /*
-     * func: name2id
-     * desc: returns integer vertex id of given vertex name.
-     *       If there is no such vertex in the graph, -1 is returned.
+     * renumbers the names:  the name of id becomes that of new_id[id].
+     *   Names with new_id[id] == -1 are dropped; the new IDs of the
+     *   others must be 0..k-1, k the number kept.
      */
-    int name2id(const string &vtx_name) {
-      if(_name2id.count(vtx_name)==0)
-        return -1;
-      return _name2id[vtx_name];
+    void permute(const vector<int> &new_id) {
+      vector<char> old_chars;
+      vector<uint64_t> old_start;
+      int id, n = size(), k = 0;
+
+      for(id=0; id<n; id++)
+        k += new_id[id] != -1;
+      old_chars.swap(chars);
+      old_start.swap(start);
+      start.assign(k+1, 0);
+      for(id=0; id<n; id++) {
+        if(new_id[id] != -1)
+          start[new_id[id]+1] = old_start[id+1] - old_start[id];
+      }
+      for(id=0; id<k; id++)
+        start[id+1] += start[id];
+      chars.resize(start[k]);
+      for(id=0; id<n; id++) {
+        if(new_id[id] != -1) {
+          std::copy(old_chars.begin() + old_start[id],
+              old_chars.begin() + old_start[id+1],
+              chars.begin() + start[new_id[id]]);
+        }
+      }
+      rehash(table.size());
     }
 
-    /*
-     * func: name_vec2string
-     * desc: utility function - if you have a bunch of
-     *   vertex names (as strings) stored in a vector, this
-     *   function puts the names in a single string with
-     *   nodes separated by single spaces.
-     *
-     *   Might be handy for things like getting an easy to
-     *   print representation of a path for example.
-     */
-    string name_vec2string(const vector<string> &vec) {
-      string s = "";
-      int i;
-
-      if(vec.size()==0)
-        return s;
+    const char * char_data() const { return chars.data(); }
+    const uint64_t * offsets() const { return start.data(); }
 
-      s = s + vec[0];
-      for(i = 1; i<vec.size(); i++) {
-        s = s + " " + vec[i];
-      }
-      return s;
+    size_t bytes() const {
+      return chars.capacity() + (start.capacity() + table.capacity())*sizeof(uint64_t);
     }
+};
 
-    /*
-     * func: id_vec2string
-     * desc: utility function - if you have a bunch of
-     *   vertex ids (ints) stored in a vector, this
-     *   function connverts them to names and builds a in a 
-     *   single string with nodes-names separated by single spaces.
-     *
-     *   Might be handy for things like getting an easy to
-     *   print representation of a path for example.
-     */
-    string id_vec2string(const vector<int> &vec) {
-      string s = "";
-      int i;
 
-      if(vec.size()==0)
-        return s;
+/*
+ * struct:  graph_file_header
+ *
+ * desc:   header of the binary graph format written by
+ *   graph::write_binary and read by graph::read_binary.
+ *
+ *   The file is the header followed by eight sections, each starting
+ *   at an 8-byte aligned file offset given in sec[]:
+ *
+ *     sec[0]  name_off   uint64_t[n+1]  vertex u's name is bytes
+ *                                       name_off[u]..name_off[u+1]-1
+ *     sec[1]  names      char[]         of this section (no '\0's)
+ *     sec[2]  out_off    int32_t[n+1]   \
+ *     sec[3]  out_tgt    int32_t[m]      |  the graph's CSR snapshot,
+ *     sec[4]  out_wt     double[m]       |  laid out exactly as it is
+ *     sec[5]  in_off     int32_t[n+1]    |  in memory so that it can
+ *     sec[6]  in_tgt     int32_t[m]      |  be used in place
+ *     sec[7]  in_wt      double[m]      /
+ *
+ *   Numbers are in the byte order of the machine that wrote the file;
+ *   byte_order lets a reader on a different machine refuse the file
+ *   rather than misread it.  version is bumped whenever the layout
+ *   changes.
+ */
+struct graph_file_header {
+  char magic[8];          // GRAPH_FILE_MAGIC (without the '\0')
+  uint32_t version;       // GRAPH_FILE_VERSION
+  uint32_t byte_order;    // GRAPH_FILE_BYTE_ORDER as written by the host
+  uint64_t n;             // number of vertices
+  uint64_t m;             // number of edges
+  uint64_t sec[8];        // file offset of each section
+
+  // fills sz[] with the size in bytes of each section
+  void section_sizes(uint64_t sz[8]) const {
+    sz[0] = (n+1)*sizeof(uint64_t);
+    sz[1] = 0;  // known only from name_off[n]
+    sz[2] = (n+1)*sizeof(int32_t);
+    sz[3] = m*sizeof(int32_t);
+    sz[4] = m*sizeof(double);
+    sz[5] = (n+1)*sizeof(int32_t);
+    sz[6] = m*sizeof(int32_t);
+    sz[7] = m*sizeof(double);
+  }
+};
 
-      s = s + id2name(vec[0]);
-      for(i = 1; i<vec.size(); i++) {
-        s = s + " " + id2name(vec[i]);
-      }
-      return s;
-    }
 
+/*
+ * struct:  alt_file_header
+ *
+ * desc:   header of the landmark table file written by
+ *   alt_index::write and read by alt_index::read.  Sections, at
+ *   8-byte aligned offsets given in sec[]:
+ *
+ *     sec[0]  landmarks  int32_t[k]    vertex IDs of the landmarks
+ *     sec[1]  fwd        double[n*k]   \  distance tables, vertex
+ *     sec[2]  bwd        double[n*k]   /  major (see alt_index)
+ *
+ *   n and m are those of the graph the tables were built for; a
+ *   reader refuses tables that don't match its graph.  magic, version
+ *   and byte_order are as in graph_file_header.
+ */
+struct alt_file_header {
+  char magic[8];          // ALT_FILE_MAGIC (without the '\0')
+  uint32_t version;       // ALT_FILE_VERSION
+  uint32_t byte_order;    // GRAPH_FILE_BYTE_ORDER as written by the host
+  uint64_t n;             // number of vertices of the graph
+  uint64_t m;             // number of edges of the graph
+  uint64_t k;             // number of landmarks
+  uint64_t sec[3];        // file offset of each section
+
+  // fills sz[] with the size in bytes of each section
+  void section_sizes(uint64_t sz[3]) const {
+    sz[0] = k*sizeof(int32_t);
+    sz[1] = n*k*sizeof(double);
+    sz[2] = n*k*sizeof(double);
+  }
+};
 
 
+/*
+ * struct:  ch_file_header
+ *
+ * desc:   header of the contraction hierarchy file written by
+ *   ch_index::write and read by ch_index::read.  Sections, at 8-byte
+ *   aligned offsets given in sec[]:
+ *
+ *     sec[0]  rank     int32_t[n]     contraction order of each vertex
+ *     sec[1]  up_off   int32_t[n+1]  \
+ *     sec[2]  up_tgt   int32_t[mu]    |  upward arcs
+ *     sec[3]  up_wt    double[mu]     |  (see ch_index)
+ *     sec[4]  up_mid   int32_t[mu]   /
+ *     sec[5]  dn_off   int32_t[n+1]  \
+ *     sec[6]  dn_tgt   int32_t[md]    |  downward arcs
+ *     sec[7]  dn_wt    double[md]     |
+ *     sec[8]  dn_mid   int32_t[md]   /
+ *
+ *   n and m are those of the graph the hierarchy was built for, as in
+ *   alt_file_header.
+ */
+struct ch_file_header {
+  char magic[8];          // CH_FILE_MAGIC (without the '\0')
+  uint32_t version;       // CH_FILE_VERSION
+  uint32_t byte_order;    // GRAPH_FILE_BYTE_ORDER as written by the host
+  uint64_t n;             // number of vertices of the graph
+  uint64_t m;             // number of edges of the graph
+  uint64_t mu;            // number of upward arcs
+  uint64_t md;            // number of downward arcs
+  uint64_t sec[9];        // file offset of each section
+
+  // fills sz[] with the size in bytes of each section
+  void section_sizes(uint64_t sz[9]) const {
+    sz[0] = n*sizeof(int32_t);
+    sz[1] = (n+1)*sizeof(int32_t);
+    sz[2] = mu*sizeof(int32_t);
+    sz[3] = mu*sizeof(double);
+    sz[4] = mu*sizeof(int32_t);
+    sz[5] = (n+1)*sizeof(int32_t);
+    sz[6] = md*sizeof(int32_t);
+    sz[7] = md*sizeof(double);
+    sz[8] = md*sizeof(int32_t);
+  }
+};
 
-    /*
-     * func: add_edge
-     * desc: adds edge (src,dest) with given weight to graph if
-     *   possible.
-     *
-     *       If edge (src,dest) is already in graph, the graph is
-     *       unchanged and false is returned.
-     *
-     *       Otherwise the edge is added and true is returned.
-     *
-     *       Note:  if src and/or dest are not currently vertices
-     *         in the graph, they will be added.
-     */
-    bool add_edge(const string &src, const string &dest, 
-        double weight=1.0) {
 
-      int s_id, d_id;
+/*
+ * struct:  mapped_file
+ *
+ * desc:   a read-only memory mapping of an entire file.  The mapping
+ *   is released when the object is destroyed; graphs that point into
+ *   a mapping (see graph::read_binary) share ownership of it through
+ *   a shared_ptr.
+ */
+struct mapped_file {
+  const char *base;
+  size_t size;
 
-      string estring = edge_string(src, dest);
+  mapped_file() : base { NULL }, size { 0 } { }
 
-      if(edges.count(estring)==1) {
-        std::cerr << "warning: duplicate edge '"
-          << estring << "'\n";
-        return false;
-      }
+  ~mapped_file() {
+    if(base != NULL)
+      munmap((void *)base, size);
+  }
 
-      edges.insert(estring);
+  // returns false if the file can't be opened, is empty or is not
+  //   a regular file
+  bool map(const string &fname) {
+    struct stat st;
+    int fd;
+    void *p;
 
-      // get id for source vertex
-      if(_name2id.count(src)==0) 
-        s_id = add_vertex(src);
-      else
-        s_id = _name2id[src];
+    fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0)
+      return false;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+      close(fd);
+      return false;
+    }
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(p == MAP_FAILED)
+      return false;
+    base = (const char *)p;
+    size = st.st_size;
+    return true;
+  }
 
-      // get id for destination vertex
-      if(_name2id.count(dest)==0) 
-        d_id = add_vertex(dest);
-      else
-        d_id = _name2id[dest];
+  private:
+    mapped_file(const mapped_file &);
+    mapped_file & operator=(const mapped_file &);
+};
 
-      vertices[s_id].outgoing.push_back(edge(d_id, weight));
-      vertices[d_id].incoming.push_back(edge(s_id, weight));
 
-      return true;
-    }
+/*
+ * valid_csr, valid_ids:  checks for the arrays of a mapped file
+ *   (graph::read_binary, alt_index::read, ch_index::read).  A file of
+ *   the right size can still hold garbage, and the arrays are used
+ *   in place, so their contents are checked once on load -- O(size)
+ *   -- rather than trusted by every algorithm that indexes with them.
+ */
 
+// off (n+1 entries) and tgt (m entries) form CSR adjacency lists:
+//   off starts at 0, never decreases and ends at m, and every target
+//   is a vertex 0..n-1
+inline bool valid_csr(const int *off, const int *tgt, uint64_t n, uint64_t m) {
+  uint64_t i;
 
-    /*
-     * func: add_edge(string &)
-     * desc: takes an edge specification as a single string, 
-     *   parses the string into src vertex, dest vertex and
-     *   weight (optional).
-     *
-     *   If parsing is successful, add_edge(string, string, double) above
-     *   is called to do the "real work".
-     *
-     * returns true on success; false on failure (parse error or
-     *   call to add_edge failed).
-     *
-     * expected format:
-     *
-     *   the given string must have either two or three tokens (exactly).
-     *
-     *   If it has three tokens, the third token must be parseable as
-     *   a double.
-     */
-    bool add_edge(const string &str) {
-      std::stringstream ss(str);
-      string src, dest, junk, weight_str;
-      double weight;
+  if(off[0] != 0 || (uint64_t)off[n] != m)
+    return false;
+  for(i=0; i<n; i++) {
+    if(off[i+1] < off[i])
+      return false;
+  }
+  for(i=0; i<m; i++) {
+    if(tgt[i] < 0 || (uint64_t)tgt[i] >= n)
+      return false;
+  }
+  return true;
+}
 
-      if(!(ss >> src))
-        return false;
-      if(!(ss >> dest))
-        return false;
-      if(!(ss >> weight_str)){
-        // only two tokens: use default weight
-        weight = 1.0;
-      }
-      else {
-        if(!(std::stringstream(weight_str) >> weight)){
-          // couldn't parse weight
-          return false;
-        }
+// each of the len IDs is in lo..n-1
+inline bool valid_ids(const int *ids, uint64_t len, int lo, uint64_t n) {
+  uint64_t i;
 
-        if(ss >> junk){
-          // extra token?  format error
-          return false;
-        }
-      }
+  for(i=0; i<len; i++) {
+    if(ids[i] < lo || (ids[i] >= 0 && (uint64_t)ids[i] >= n))
+      return false;
+  }
+  return true;
+}
 
-      add_edge(src, dest, weight);
 
-      return true;
-    }
+/*
+ * class:  flat_array
+ *
+ * desc:   a fixed-size array of T which either owns its elements (in
+ *   a vector) or is a view of elements that live somewhere else --
+ *   e.g., inside a memory-mapped file.  Reads look the same either
+ *   way, which is what lets a graph run directly on a mapped file.
+ *
+ *   assign/resize always switch to owned storage.  Writing through
+ *   operator[] is only allowed on owned storage.
+ */
+template <typename T>
+class flat_array {
 
-    void _add_edge(const string &str) {
+  private:
+    vector<T> own;
+    T *ptr;
+    size_t n;
 
-      if(!add_edge(str))
-        std::cout << "add_edge failed; str='" <<
-          str << "'\n";
+  public:
+    flat_array() : ptr { NULL }, n { 0 } { }
+
+    flat_array(const flat_array &o) : own { o.own } {
+      ptr = o.owns() ? own.data() : o.ptr;
+      n = o.n;
     }
 
-    void display(){
-      int u;
+    flat_array & operator=(const flat_array &o) {
+      if(this != &o) {
+        own = o.own;
+        ptr = o.owns() ? own.data() : o.ptr;
+        n = o.n;
+      }
+      return *this;
+    }
 
-      for(u=0; u<vertices.size(); u++) {
-        std::cout << vertices[u].name << " : ";
+    bool owns() const {
+      return ptr == own.data();
+    }
 
-        for(edge &e : vertices[u].outgoing) 
-          p_edge(e);
-        std::cout << "\n";
-      }
+    // make this a view of [p, p+count)
+    void view(const T *p, size_t count) {
+      vector<T>().swap(own);
+      ptr = const_cast<T *>(p);
+      n = count;
     }
 
-    /*
-     * func: ids2names
-     * desc: utility function which takes a vector of vertex IDs
-     *   and populates another vector of strings with the corresponding
-     *   vertex names.
-     */
-    void ids2names(std::vector<int> &  ids, std::vector<string> & names) {
-      names.clear();
+    void assign(size_t count, const T &val) {
+      own.assign(count, val);
+      ptr = own.data();
+      n = count;
+    }
 
-      for(int &u : ids) {
-        names.push_back(id2name(u));
-      }
+    void resize(size_t count) {
+      if(!owns())
+        own.assign(ptr, ptr+n);
+      own.resize(count);
+      ptr = own.data();
+      n = count;
     }
 
-    /* 
-     * func: read_file
-     * desc: reades given file (if possible) as a 
-     *   sequence of edges -- one edge per line.
-     *
-     *   Each line is expected to be in the form:
-   
-           <source-vertex> <dest-vertex> {<weight>}
-     *
-     * where the vertices are given as strings and
-     *   the edge weight is a number (read as a double).
-     * The edge weight is optional (indicated by {}).
-     *
-     * Examples:
-         an edge from Chicago to NewYork with weight 201.9:
+    void swap(flat_array &o) {
+      own.swap(o.own);
+      std::swap(ptr, o.ptr);
+      std::swap(n, o.n);
+    }
 
-            Chicago NewYork 201.9
- 
-         an edge from Bob to Alice with no weight:
+    T & operator[](size_t i) { return ptr[i]; }
+    const T & operator[](size_t i) const { return ptr[i]; }
+    size_t size() const { return n; }
+    const T * data() const { return ptr; }
+    const T * begin() const { return ptr; }
+    const T * end() const { return ptr+n; }
+};
 
-             Bob Alice
 
-     * if no weight is specified, the edge defaults to a weight
-     *   of 1.0
-     */
-    bool read_file(const string &fname) {
-      std::ifstream file;
-      string line;
+/*
+ * Path counters.
+ *
+ *   The number of paths in a graph can grow exponentially with its
+ *   depth, so the path-counting functions (graph::dag_num_paths,
+ *   graph::bfs_num_paths) are templates on the counter type.  Besides
+ *   plain uint64_t, these are available:
+ *
+ *     sat_count128:  128-bit count which sticks at its maximum value
+ *       instead of wrapping around, so an overflow is never silent.
+ *
+ *     mod_count<P>:  the count modulo a prime P (P < 2^63) -- exact
+ *       residues for hashing and fingerprinting.  mod_count_m61 uses
+ *       the Mersenne prime 2^61-1.
+ *
+ *     log_count:  the natural logarithm of the count, as a double.
+ *       Approximate, but it can represent counts far beyond 2^1000.
+ *
+ *   All of them can be built from an integer and support += and *,
+ *   which is all the counting code uses, and can be printed with <<.
+ */
+struct sat_count128 {
+  unsigned __int128 v;
 
-      file.open(fname, std::ios::in);
-      if(!file.is_open())
-        return false;
-      
-      while(getline(file, line)) {
-        // skip blank lines
-        if(line.length() > 0) {
-          if(!add_edge(line)) {
-            std::cerr << "warning: skipped input line '" 
-              << line << "' (ill-formatted)\n";
-          }
-        }
-      }
-      file.close();
-      return true;
-    }
+  static unsigned __int128 max() {
+    return ~(unsigned __int128)0;
+  }
 
+  sat_count128(unsigned long long x=0) : v { x } { }
 
-    int num_nodes() {
-      return vertices.size();
-    }
-    int num_edges() {
-      return edges.size();
-    }
+  sat_count128 & operator+=(const sat_count128 &o) {
+    v = (v + o.v < v) ? max() : v + o.v;
+    return *this;
+  }
 
-  private:
-    void init_report(std::vector<vertex_label> & report) {
-      int u;
+  sat_count128 operator*(const sat_count128 &o) const {
+    sat_count128 r;
+    r.v = (v != 0 && o.v > max() / v) ? max() : v * o.v;
+    return r;
+  }
 
-      report.clear();
-      for(u=0; u<vertices.size(); u++) {
-        report.push_back(vertex_label(-1, -1, UNDISCOVERED));
-      }
-    }
+  bool saturated() const {
+    return v == max();
+  }
 
+  // value as a long long, clamped to LLONG_MAX
+  long long clamp() const {
+    return v > (unsigned __int128)LLONG_MAX ? LLONG_MAX : (long long)v;
+  }
 
-  public:
-    /*
-     * TODO 10 points
-     *
-     * modify bfs so that vertex labels reflect the NUMBER OF 
-     *   SHORTEST PATHS TO THE VERTEX LABELED:
-     *
-     *     report[u].npaths is assigned the number of shortest 
-     *        paths from src to u.
-     *
-     *   OBSERVATIONS:
-     *
-     *     report[src].npaths will be 1.
-     *
-     *     if a vertex u is not reachable from src, then 
-     *     report[u].npaths will be assigned 0. 
-     *
-     * RUNTIME:  bfs must still be O(V+E).
-     *
-     */   
-    bool bfs(int src, std::vector<vertex_label> &report) 
-    {
-      int u, v;
-      std::queue<int> q;
+  friend std::ostream & operator<<(std::ostream &os, const sat_count128 &c) {
+    char buf[48], *p = buf + sizeof(buf);
+    unsigned __int128 x = c.v;
 
-      if(src < 0 || src >= num_nodes())
-        return false;
+    *--p = '\0';
+    do {
+      *--p = '0' + (int)(x % 10);
+      x /= 10;
+    } while(x != 0);
+    return os << (c.saturated() ? ">=" : "") << p;
+  }
+};
 
-      init_report(report);
+template <uint64_t P>
+struct mod_count {
+  uint64_t v;
 
-      report[src].dist = 0;
+  mod_count(unsigned long long x=0) : v { x % P } { }
 
-      // since src is the root of the bfs tree, it has no 
-      //   predecessor.
-      // By convention, we set the predecessor to itself.
-      report[src].pred = src;
-      report[src].npaths++;
-      report[src].state = DISCOVERED;
-      q.push(src);
+  mod_count & operator+=(const mod_count &o) {
+    v += o.v;
+    if(v >= P)
+      v -= P;
+    return *this;
+  }
 
-      while(!q.empty()) {
-        // dequeue front node from queue
-        u = q.front();
-        q.pop();
+  mod_count operator*(const mod_count &o) const {
+    mod_count r;
+    r.v = (uint64_t)((unsigned __int128)v * o.v % P);
+    return r;
+  }
 
-        // examine outgoing edges of u
-        for(edge &e : vertices[u].outgoing) {
-          v = e.vertex_id;
-          if(report[v].state == UNDISCOVERED) {
-              
-            report[v].npaths= report[u].npaths + report[v].npaths;
-            report[v].dist = report[u].dist + 1;
-            report[v].pred = u;
-            report[v].state = DISCOVERED;
-          
-            // enqueue newly discovered vertex
-            q.push(v);
-          }
-          else
-          {
-              if (report[v].dist == report[u].dist+1 )
-              {
-                 
-                  report[v].npaths = report[u].npaths+ report[v].npaths;
+  friend std::ostream & operator<<(std::ostream &os, const mod_count &c) {
+    return os << c.v << " (mod " << P << ")";
+  }
+};
 
-              }
-              
-          }
-          
-        }
-      }
-      return true;
-    }
+typedef mod_count<(1ULL << 61) - 1> mod_count_m61;
 
-    bool bfs(const string src, std::vector<vertex_label> &report) {
-      int u;
+struct log_count {
+  double l;   // log(count); -infinity for a count of 0
 
-      if((u=name2id(src)) == -1)
-          return false;
-      bfs(u, report);
-      return true;
-    }
+  log_count(unsigned long long x=0)
+    : l { x == 0 ? -HUGE_VAL : std::log((double)x) } { }
+
+  log_count & operator+=(const log_count &o) {
+    // log(e^a + e^b) without leaving the log domain
+    double hi = std::max(l, o.l), lo = std::min(l, o.l);
+    if(lo != -HUGE_VAL)
+      l = hi + std::log1p(std::exp(lo - hi));
+    else
+      l = hi;
+    return *this;
+  }
+
+  log_count operator*(const log_count &o) const {
+    log_count r;
+    r.l = l + o.l;
+    return r;
+  }
+
+  // prints the count in scientific notation, e.g. 1.60694e+60
+  friend std::ostream & operator<<(std::ostream &os, const log_count &c) {
+    if(c.l == -HUGE_VAL)
+      return os << 0;
+    double e10 = std::floor(c.l / std::log(10.0));
+    return os << std::exp(c.l - e10*std::log(10.0)) << "e+" << (long long)e10;
+  }
+};
+
+/*
+ * gather_sum:  the sum of vals[idx[i]] for lo <= i < hi, the inner loop
+ *   of the path-counting sweeps.  A plain loop, which the compiler may
+ *   turn into SIMD gathers when the target has them; counter types
+ *   with a cheaper way to add up many terms specialize it.
+ */
+template <typename C>
+C gather_sum(const C *vals, const int *idx, int lo, int hi) {
+  C sum(0);
+
+  for(int i=lo; i<hi; i++)
+    sum += vals[idx[i]];
+  return sum;
+}
+
+// log_count:  log(sum of e^l) as max + log(sum of e^(l - max)), one
+//   exp per term and one log per sum instead of an exp and a log1p per
+//   term
+template <>
+inline log_count gather_sum(const log_count *vals, const int *idx,
+    int lo, int hi) {
+  log_count r;
+  double sum = 0;
+  int i;
+
+  r.l = -HUGE_VAL;
+  for(i=lo; i<hi; i++)
+    r.l = std::max(r.l, vals[idx[i]].l);
+  if(r.l == -HUGE_VAL)
+    return r;
+  for(i=lo; i<hi; i++)
+    sum += std::exp(vals[idx[i]].l - r.l);
+  r.l += std::log(sum);
+  return r;
+}
+
+
+/*
+ * Priority queues for graph::dijkstra.
+ *
+ *   Dijkstra's algorithm is parameterized by its priority queue.  Each
+ *   of the queues below holds vertex IDs 0..n-1 keyed by tentative
+ *   distance and has the same interface:
+ *
+ *     reset(n)        empty the queue, for vertex IDs 0..n-1
+ *     push(v, key)    insert v, or lower the key of v if it is in the
+ *                     queue already (key must not be larger)
+ *     empty()
+ *     pop(key)        remove and return the vertex with the smallest
+ *                     key; its key is stored in key
+ *
+ *   and a static member integer_keys telling whether it only works
+ *   for integer keys.
+ *
+ *     binary_heap:   array-based binary heap with a position index
+ *                    for decrease-key.  O(log n) per operation.
+ *     pairing_heap:  O(1) insert and (amortized, in practice)
+ *                    decrease-key; O(log n) amortized pop.
+ *     radix_heap:    monotone queue for integer keys:  keys are kept
+ *                    in buckets by their highest bit differing from the
+ *                    last key popped, so each entry moves down at most
+ *                    64 times.  Fastest for integer weights.
+ */
+class binary_heap {
 
   private:
-    void _dfs(int u, vector<vertex_label> & rpt, bool &cycle) {
-      int v;
+    vector<int> heap;       // vertex IDs; heap[0] has the smallest key
+    vector<int> pos;        // pos[v]: index of v in heap (-1: not in it)
+    vector<double> key;
+
+    void up(int i) {
+      int v = heap[i];
+      while(i > 0 && key[heap[(i-1)/2]] > key[v]) {
+        heap[i] = heap[(i-1)/2];
+        pos[heap[i]] = i;
+        i = (i-1)/2;
+      }
+      heap[i] = v;
+      pos[v] = i;
+    }
 
-      rpt[u].state = ACTIVE;
-      for(edge &e : vertices[u].outgoing) {
-        v = e.vertex_id;
-        if(rpt[v].state == UNDISCOVERED) {
-          rpt[v].pred = u;
-          rpt[v].dist = rpt[u].dist + 1;
-          _dfs(v, rpt, cycle);
-        }
-        if(rpt[v].state == ACTIVE) 
-          cycle = true;
+    void down(int i) {
+      int v = heap[i], c, n = heap.size();
+      while((c = 2*i+1) < n) {
+        if(c+1 < n && key[heap[c+1]] < key[heap[c]])
+          c++;
+        if(key[heap[c]] >= key[v])
+          break;
+        heap[i] = heap[c];
+        pos[heap[i]] = i;
+        i = c;
       }
-      rpt[u].state = FINISHED;
+      heap[i] = v;
+      pos[v] = i;
     }
 
   public:
-    bool dfs(int u, vector<vertex_label> & rpt, bool &cycle) {
+    static const bool integer_keys = false;
 
-      if(u < 0 || u >= num_nodes()) 
-        return false;
+    void reset(int n) {
+      heap.clear();
+      pos.assign(n, -1);
+      key.assign(n, 0);
+    }
 
-      cycle = false;
+    void push(int v, double k) {
+      key[v] = k;
+      if(pos[v] == -1) {
+        heap.push_back(v);
+        up(heap.size()-1);
+      }
+      else
+        up(pos[v]);
+    }
 
-      init_report(rpt);
-      rpt[u].pred = u;
-      rpt[u].dist = 0;
-      _dfs(u, rpt, cycle);
-      return true;
+    bool empty() const {
+      return heap.empty();
     }
 
-    bool dfs(const string &src, vector<vertex_label> & rpt, bool &cycle) {
-      int u;
+    int pop(double &k) {
+      int v = heap[0];
+      k = key[v];
+      pos[v] = -1;
+      heap[0] = heap.back();
+      heap.pop_back();
+      if(!heap.empty())
+        down(0);
+      return v;
+    }
+};
 
-      if((u=name2id(src)) == -1)
-          return false;
-      dfs(u, rpt, cycle);
-      return true;
+class pairing_heap {
+
+  private:
+    // each vertex is a node of a heap-ordered tree:  child is its
+    //   leftmost child, sibling the next child of the same parent, and
+    //   prev the parent (leftmost child) or the left sibling
+    vector<int> child, sibling, prev;
+    vector<double> key;
+    vector<char> in_heap;
+    vector<int> roots;      // work space for pop
+    int root;
+
+    // links two roots; returns the new root
+    int meld(int a, int b) {
+      if(key[b] < key[a])
+        std::swap(a, b);
+      sibling[b] = child[a];
+      if(child[a] != -1)
+        prev[child[a]] = b;
+      prev[b] = a;
+      child[a] = b;
+      return a;
     }
 
-    bool has_cycle() {
-      int u;
-      bool cycle=false;
-      vector<vertex_label> rpt;
+  public:
+    static const bool integer_keys = false;
+
+    void reset(int n) {
+      child.assign(n, -1);
+      sibling.assign(n, -1);
+      prev.assign(n, -1);
+      key.assign(n, 0);
+      in_heap.assign(n, 0);
+      root = -1;
+    }
 
-      init_report(rpt);
-      for(u=0; u<num_nodes(); u++) {
-        if(rpt[u].state == UNDISCOVERED) {
-          _dfs(u, rpt, cycle);
-          if(cycle)
-            return true;
-        }
+    void push(int v, double k) {
+      key[v] = k;
+      if(!in_heap[v]) {
+        in_heap[v] = 1;
+        child[v] = sibling[v] = prev[v] = -1;
+        root = (root == -1) ? v : meld(root, v);
+      }
+      else if(v != root) {
+        // cut v's subtree out and meld it with the root
+        if(child[prev[v]] == v)
+          child[prev[v]] = sibling[v];
+        else
+          sibling[prev[v]] = sibling[v];
+        if(sibling[v] != -1)
+          prev[sibling[v]] = prev[v];
+        sibling[v] = prev[v] = -1;
+        root = meld(root, v);
       }
-      return false;
     }
 
-    bool topo_sort(std::vector<int> &order) {
-      std::queue<int> q;
-      std::vector<int> indegrees;
-      int u, v;
-      int indeg;
-      order.clear();
-      if(has_cycle())
-        return false;
+    bool empty() const {
+      return root == -1;
+    }
+
+    int pop(double &k) {
+      int v = root, c, i;
+
+      k = key[v];
+      in_heap[v] = 0;
+
+      // two-pass pairing of the children:  meld them in pairs left to
+      //   right, then meld the pairs right to left
+      roots.clear();
+      for(c = child[v]; c != -1; c = sibling[c])
+        roots.push_back(c);
+      for(int r : roots)
+        sibling[r] = prev[r] = -1;
+      for(i=0; i+1<(int)roots.size(); i+=2)
+        roots[i/2] = meld(roots[i], roots[i+1]);
+      if(roots.size() % 2 == 1)
+        roots[roots.size()/2] = roots.back();
+      roots.resize((roots.size()+1)/2);
+
+      root = -1;
+      for(i=roots.size()-1; i>=0; i--)
+        root = (root == -1) ? roots[i] : meld(roots[i], root);
+      return v;
+    }
+};
+
+class radix_heap {
+
+  private:
+    vector<std::pair<uint64_t, int> > bucket[65];
+    vector<uint64_t> key;       // current key of each vertex
+    vector<char> in_heap;
+    uint64_t last;              // last key popped
+    size_t live;                // vertices in the queue
+
+    // 0 if k == last, otherwise 1 + index of the highest bit in which
+    //   they differ
+    int bucket_of(uint64_t k) const {
+      return k == last ? 0 : 64 - __builtin_clzll(k ^ last);
+    }
 
-      for(u=0; u<num_nodes(); u++) {
-        indeg = vertices[u].incoming.size();
+  public:
+    static const bool integer_keys = true;
+
+    void reset(int n) {
+      for(int b=0; b<65; b++)
+        bucket[b].clear();
+      key.assign(n, 0);
+      in_heap.assign(n, 0);
+      last = 0;
+      live = 0;
+    }
 
-        indegrees.push_back(indeg);
-        if(indeg==0)
-          q.push(u);
+    // a decrease-key just adds another entry; the old one is skipped
+    //   when it comes out (see pop)
+    void push(int v, double k) {
+      key[v] = (uint64_t)k;
+      if(!in_heap[v]) {
+        in_heap[v] = 1;
+        live++;
       }
+      bucket[bucket_of(key[v])].push_back(std::make_pair(key[v], v));
+    }
 
-      while(!q.empty()){
-        u = q.front();
-        q.pop();
-        order.push_back(u);
-        for(edge &e : vertices[u].outgoing) {
-          v = e.vertex_id;
-          indegrees[v]--;
-          if(indegrees[v]==0) 
-            q.push(v);
+    bool empty() const {
+      return live == 0;
+    }
+
+    int pop(double &k) {
+      int b;
+      std::pair<uint64_t, int> e;
+
+      while(true) {
+        if(bucket[0].empty()) {
+          // move the smallest non-empty bucket down:  its minimum key
+          //   becomes last, and every entry lands in a lower bucket
+          for(b=1; bucket[b].empty(); b++)
+            ;
+          last = bucket[b][0].first;
+          for(auto &x : bucket[b])
+            last = std::min(last, x.first);
+          for(auto &x : bucket[b])
+            bucket[bucket_of(x.first)].push_back(x);
+          bucket[b].clear();
         }
+        e = bucket[0].back();
+        bucket[0].pop_back();
+        // skip entries left behind by decrease-key
+        if(in_heap[e.second] && key[e.second] == e.first)
+          break;
       }
-      return true;
+      in_heap[e.second] = 0;
+      live--;
+      k = (double)e.first;
+      return e.second;
     }
+};
 
 
+/*
+ * class:  worker_pool
+ *
+ * desc:   a fixed set of threads for running the parallel graph
+ *   algorithms.  Threads are started once and then wait for work, so
+ *   that algorithms which synchronize many times (e.g., once per BFS
+ *   level) don't pay for starting threads every time.
+ *
+ *   run(fn) calls fn(tid) once for every tid in 0..size()-1 -- tid 0
+ *   on the calling thread -- and returns when all calls are done.
+ *
+ *   for_blocks(n, fn) splits 0..n-1 into blocks which the threads
+ *   claim dynamically and calls fn(lo, hi, tid) for each block.
+ */
+class worker_pool {
 
-    void disp_report(const vector<vertex_label> & rpt, bool print_paths=false) {
-      int u;
-      vector<int> path;
-
-        // THIS if STATEMENT IS NEW
-        if(rpt.size() != num_nodes()) {
-          std::cerr << "error - disp_report(): report vector has incorrect length\n";
+  private:
+    vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable start_cv, done_cv;
+    const std::function<void(int)> *job;
+    unsigned long generation;
+    int busy;
+    bool stopping;
+
+    void worker(int tid) {
+      unsigned long seen = 0;
+
+      while(true) {
+        std::unique_lock<std::mutex> lock(mtx);
+        start_cv.wait(lock, [&]{ return stopping || generation != seen; });
+        if(stopping)
           return;
-        }
+        seen = generation;
+        lock.unlock();
 
-        for(u=0; u<num_nodes(); u++) {
-          std::cout << id2name(u) << " : dist=" <<  rpt[u].dist
-            << " ; pred=" <<  id2name(rpt[u].pred) << 
-            " ; state='" << rpt[u].state << "'; npaths=" << 
-            rpt[u].npaths << "\n";
-          if(print_paths) {
-            extract_path(rpt, u, path);
-            std::cout << "     PATH: <" + id_vec2string(path) + ">\n";
-          }
-        }
+        (*job)(tid);
+
+        lock.lock();
+        if(--busy == 0)
+          done_cv.notify_one();
+      }
     }
 
-    /******************************************************
-     *
-     * Vocabulary:  
-     *
-     *   In a DAG G:
-     *   
-     *       inputs:  subset of vertices with INDEGREE ZERO
-     *
-     *       outputs: subset of vertices with OUTDEGREE ZERO
-     *
-     *       input-path: a path in G STARTING AT AN INPUT VERTEX
-     *          (and ending at any vertex).
-     *
-     *       output-path:  a path in G starting at any vertex and
-     *          ENDING AT AN OUTPUT VERTEX.
-     *
-     *       input-output-path (or io-path):  a path STARTING AT
-     *          AN INPUT VERTEX _AND_ ENDING AT AN OUTPUT VERTEX.
-     *
-     */
+  public:
+    // nthreads <= 0 means one per hardware thread
+    explicit worker_pool(int nthreads=0)
+      : job { NULL }, generation { 0 }, busy { 0 }, stopping { false } {
+      int t;
+
+      if(nthreads <= 0)
+        nthreads = std::thread::hardware_concurrency();
+      if(nthreads <= 0)
+        nthreads = 1;
+      for(t=1; t<nthreads; t++)
+        threads.push_back(std::thread(&worker_pool::worker, this, t));
+    }
 
-    /* TODO 20 points
-     * function:  extract_path
-     * desc:  extracts the path (if any) encoded by vertex labels
-     *        ending at vertex dest (as an int ID).  Resulting path
-     *        is stored in the int vector path (sequence of vertex
-     *        IDs ENDING WITH dest -- i.e., in "forward order").
-     *
-     *     parameters:
-     *       rpt:  vector of vertex labels associated with given
-     *             graph (calling object).  Presumption:  labels
-     *             have been previously populated by another function
-     *             like bfs, dfs, or critical_paths.
-     *
-     *       dest: vertex ID of the target/destination vertex.
-     *
-     *       path: int vector in which the constructed path is stored.
-     *
-     * returns:  true on success; false otherwise.
-     *           failure:  there is no encoded path ending at vertex
-     *              dest (see discussion below);
-     *              OR, the rpt vector is not of the correct dimension.
-     *
-     * Notes:  predecessor conventions:
-     *
-     *      SOURCE VERTICES:
-     *
-     *         if vertex u is a "source" vertex such as:
-     *
-     *             the source vertex of BFS or DFS or
-     *             an input vertex in a DAG (perhaps analyzed by 
-     *                dag_critical_paths).
-     *
-     *         then the predecessor of u is u itself:
-     *
-     *              rpt[u].pred==u
-     *
-     *      UNREACHABLE VERTICES:
-     *
-     *          if rpt[u].pred == -1, this indicates that THERE IS 
-     *          NO PATH ENDING AT VERTEX u.
-     *
-     *          In this situation, the path vector is made empty and
-     *          false is returned.
-     *
-     *  RUNTIME:  O(|p|) where |p| is the number of edges on 
-     *    the path extracted.
-     *
-     */
-    bool extract_path(const vector<vertex_label> & rpt, int dest, vector<int> & path) {
-      path.clear();
-      if(rpt.size() != num_nodes())
+    ~worker_pool() {
       {
-          return false;
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
       }
-      
-      if(rpt[dest].pred ==-1)
-      {
-          path.clear();
-           return false;
+      start_cv.notify_all();
+      for(std::thread &t : threads)
+        t.join();
+    }
+
+    int size() const {
+      return threads.size() + 1;
+    }
+
+    void run(const std::function<void(int)> &fn) {
+      if(threads.empty()) {
+        fn(0);
+        return;
       }
-      if(rpt[dest].pred == dest)
       {
-          path.push_back(dest);
-          return true;
-
+        std::lock_guard<std::mutex> lock(mtx);
+        job = &fn;
+        busy = threads.size();
+        generation++;
       }
-      extract_path(rpt, rpt[dest].pred, path);
-      
-      path.push_back(dest);
-
-      return true;  // placeholder
+      start_cv.notify_all();
+      fn(0);
+      std::unique_lock<std::mutex> lock(mtx);
+      done_cv.wait(lock, [&]{ return busy == 0; });
+    }
+
+    void for_blocks(size_t n, const std::function<void(size_t, size_t, int)> &fn,
+        size_t block=1024) {
+      std::atomic<size_t> next(0);
+
+      if(n <= block || threads.empty()) {
+        if(n > 0)
+          fn(0, n, 0);
+        return;
+      }
+      run([&](int tid) {
+        size_t lo;
+        while((lo = next.fetch_add(block)) < n)
+          fn(lo, std::min(n, lo+block), tid);
+      });
+    }
+
+  private:
+    worker_pool(const worker_pool &);
+    worker_pool & operator=(const worker_pool &);
+};
+
+
+/*
+ * struct:  edge_list_chunk
+ *
+ * desc:   parses one newline-aligned piece of an edge-list file (see
+ *   graph::read_file for the format) without building any
+ *   std::strings or stringstreams.  Several chunks of the same file
+ *   can be parsed by different threads at the same time; the results
+ *   are then merged, in file order, by the graph.
+ *
+ *   After parse():
+ *
+ *     names:  the distinct vertex names in the chunk (pointers into
+ *        the file buffer), in the order in which they first appear.
+ *
+ *     lines:  one record per non-blank line, in file order.  For a
+ *        well-formed line, src and dest are indices into names.  For
+ *        an ill-formatted line src is -1 and bad[dest] is the text of
+ *        the line (so the same warning can be printed).
+ */
+struct edge_list_chunk {
+
+  struct token {
+    const char *p;
+    size_t len;
+  };
+
+  struct token_hash {
+    size_t operator()(const token &t) const {
+      // FNV-1a
+      size_t h = 14695981039346656037ULL;
+      for(size_t i=0; i<t.len; i++) {
+        h ^= (unsigned char)t.p[i];
+        h *= 1099511628211ULL;
+      }
+      return h;
+    }
+  };
+
+  struct token_eq {
+    bool operator()(const token &a, const token &b) const {
+      return a.len == b.len && std::equal(a.p, a.p+a.len, b.p);
+    }
+  };
+
+  struct line_rec {
+    int src;
+    int dest;
+    double weight;
+  };
+
+  vector<token> names;
+  vector<line_rec> lines;
+  vector<token> bad;
+
+  // same set of characters that operator>> treats as white space
+  static bool is_ws(char c) {
+    return c==' ' || c=='\t' || c=='\n' || c=='\v' || c=='\f' || c=='\r';
+  }
+
+  /*
+   * parses a number from the start of [b,e) the same way
+   *   std::stringstream >> double does:  the longest prefix of the
+   *   form  [+-] digits [. digits] [(e|E) [+-] digits]  is used and
+   *   anything after it is ignored.  Returns false if there is no
+   *   such prefix (or the value overflows).
+   *
+   *   Values with at most 15 significant digits and a small decimal
+   *   exponent are converted exactly with one multiply/divide by an
+   *   exact power of ten; anything else goes through strtod.
+   */
+  static bool parse_weight(const char *b, const char *e, double &w) {
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+      1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+      1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char *p = b;
+    bool neg = false;
+    uint64_t mant = 0;
+    int ndigits = 0, sig = 0, exp10 = 0;
+
+    if(p<e && (*p=='+' || *p=='-'))
+      neg = (*p++ == '-');
+    for( ; p<e && *p>='0' && *p<='9'; p++, ndigits++) {
+      if(sig < 19) {
+        if(mant || *p!='0') sig++;
+        mant = 10*mant + (*p-'0');
+      }
+      else
+        exp10++;
+    }
+    if(p<e && *p=='.') {
+      for(p++; p<e && *p>='0' && *p<='9'; p++, ndigits++) {
+        if(sig < 19) {
+          if(mant || *p!='0') sig++;
+          mant = 10*mant + (*p-'0');
+          exp10--;
+        }
+      }
+    }
+    if(ndigits == 0)
+      return false;
+    if(p<e && (*p=='e' || *p=='E')) {
+      const char *q = p+1;
+      bool eneg = false;
+      int x = 0;
+
+      if(q<e && (*q=='+' || *q=='-'))
+        eneg = (*q++ == '-');
+      if(!(q<e && *q>='0' && *q<='9'))
+        return false;   // "1e" is rejected by operator>> too
+      for( ; q<e && *q>='0' && *q<='9'; q++) {
+        if(x < 100000)
+          x = 10*x + (*q-'0');
+      }
+      exp10 += eneg ? -x : x;
+      p = q;
+    }
+
+    if(sig <= 15 && exp10 >= -22 && exp10 <= 22) {
+      w = (double)mant;
+      w = exp10 < 0 ? w / pow10[-exp10] : w * pow10[exp10];
+    }
+    else {
+      string num(b, p);
+      errno = 0;
+      w = std::strtod(num.c_str(), NULL);
+      if(errno == ERANGE && (w > 1.0 || w < -1.0))
+        return false;
+      return true;
+    }
+    if(neg)
+      w = -w;
+    return true;
+  }
+
+  void parse(const char *b, const char *e) {
+    unordered_map<token, int, token_hash, token_eq> ids;
+    const char *lb, *le, *p;
+    token tok[3];
+    int ntok;
+    line_rec rec;
+
+    for(lb=b; lb<e; lb=le+1) {
+      le = lb;
+      while(le<e && *le!='\n')
+        le++;
+      if(le == lb)
+        continue;   // skip blank lines
+
+      // split into tokens (a 4th token is counted, not kept)
+      ntok = 0;
+      p = lb;
+      while(ntok < 4) {
+        while(p<le && is_ws(*p))
+          p++;
+        if(p == le)
+          break;
+        const char *t = p;
+        while(p<le && !is_ws(*p))
+          p++;
+        if(ntok < 3) {
+          tok[ntok].p = t;
+          tok[ntok].len = p-t;
+        }
+        ntok++;
+      }
+
+      rec.weight = 1.0;
+      if(ntok < 2 || ntok > 3 ||
+          (ntok == 3 && !parse_weight(tok[2].p, tok[2].p+tok[2].len,
+                                      rec.weight))) {
+        token line = { lb, (size_t)(le-lb) };
+        rec.src = -1;
+        rec.dest = bad.size();
+        bad.push_back(line);
+      }
+      else {
+        auto r = ids.emplace(tok[0], (int)names.size());
+        if(r.second)
+          names.push_back(tok[0]);
+        rec.src = r.first->second;
+        r = ids.emplace(tok[1], (int)names.size());
+        if(r.second)
+          names.push_back(tok[1]);
+        rec.dest = r.first->second;
+      }
+      lines.push_back(rec);
+    }
+  }
+};
+
+
+/*
+ * class:  graph
+ *
+ * desc:   class for representing directed graphs.  Uses the
+ *   adjacency list representation.
+ *
+ * key concepts:
+ *
+ *   - Each vertex is identified by a string AND by an integer ID:
+ *       o strings are convenient for the outside world -- we can 
+ *         give vertices meaningful real-world names like Chicago
+ *         and Peoria
+ *       o On the other hand, refering to vertices with simple integer IDs
+ *           0..|V|-1 is convenient and efficient for algorithm 
+ *           implementation of many algorithms.
+ *
+ *       ref:  see the read_file function (which reads edges as string pairs).
+ *
+ *   - mapping between vertex names and vertex-IDs:
+ *       the graph class has a data member called _names (a name_arena)
+ *       which stores the name of every vertex and maps names (strings)
+ *       back to the corresponding vertex IDs.
+ *
+ *   - Key data structures and types:
+ *
+ *       vertices:  The graph class also contains a data member called vertices.
+ *         It is the core of the adjacency list representation and is where most 
+ *         of the action is!  It is a vector of type vertex.
+ *         It is indexed by vertex ID.
+ *
+ *       vertex struct:  within a vertex struct there are three data members which
+ *         capture what we need to know about a vertex:
+ *
+ *              id:  integer id associated with vertex (not used very often...)
+ *              incoming:  a vector of incoming edges (edges for which this
+ *                  vertex is the destination vertex).  The edge struct is 
+ *                  the element type of the vector (see below).
+ *              outgoing:  a vector of outgoing edges (edges for which this
+ *                  vertex is the source vertex).
+ *
+ *         (the name of vertex u is in _names; see id2name)
+ *
+ *       edge struct:  this struct captures what we need to know about an edge
+ *          in the context of an adjacency list representation.  There are two
+ *          data members:
+ *
+ *              vertex_id:  this is the id of the "other" vertex.  If 
+ *                 an edge struct is part of a vector of outgoing edges, 
+ *                 then vertex_id refers to the DESTINATION vertex of the edge;
+ *                 if it is part of a vector of incoming edges, then
+ *                 vertex_id refers to the SOURCE vertex of the edge.
+ *              
+ *              weight:  this is a floating point number giving the weight of
+ *                 the edge.  It defaults to 1.0 and is not relevant for
+ *                 all operations you might want to perform on a graph.
+ *
+ *  ------------------------------------------------------------------
+ *
+ *  The vertex_label struct:  When a graph algorithm (like bfs or dfs) is 
+ *    run, it will often record its results via "labels" associated with the
+ *    vertices.  Accordingly, we have a vertex_label structure for this purpose.
+ *
+ *  A particular algorithm will populate a vector of vertex labels (where the
+ *    vector is indexed by vertex id).  Some of the fields in the label struct
+ *    may only be relevant for certain algorithms.  Take a look at bfs to get
+ *    an idea of how an algorithm sets the labels of vertices.
+ *
+ *  Note that a label is not part of the vertex struct itself, and a vector 
+ *    of labels is not part of a graph instance.  This may seem strange at 
+ *    first, but when you consider that, for example, on a particular graph, you might
+ *    want to run bfs from some vertex A and also from some vertex B; by 
+ *    separating the labels from the graph instance, we can keep the results of
+ *    both of these runs.
+ *
+ *  Vocabulary:  a vector of labels populated by a particular algorithm is 
+ *    typically referred to as a "report" (i.e., the algorithm reports its 
+ *    results via such a vector).
+ *  
+ */
+
+class graph {
+
+  friend class dynamic_topo;
+  friend class alt_index;
+  friend class ch_index;
+  friend class reach_index;
+
+  private:
+
+    // note:  this struct does not store both
+    //   vertices in the edge -- just one.  This
+    //   is because of the overall structure of
+    //   the adjacency list organization:  an
+    //   edge struct is stored in a vector associated
+    //   with the other vertex.
+    //   A removed edge leaves a "tombstone" in both of its lists:  an
+    //   entry with vertex_id -1 (see remove_edge).
+    struct edge {
+      int vertex_id;
+      double weight;
+      edge ( int vtx_id=0, double _weight=1.0) 
+        : vertex_id { vtx_id}, weight { _weight} 
+      { }
+    };
+
+    // a vertex struct stores all info about a particular
+    //    vertex:  ID, incoming and outgoing edges.  (Names are
+    //    kept together in _names.)  The ID of a removed vertex is -1
+    //    (see remove_vertex).
+    struct vertex {
+      int id;
+      vector<edge> outgoing;
+      vector<edge> incoming;
+
+      vertex ( int _id=0) 
+        : id { _id } 
+      { }
+    };
+
+    /**************************************************
+    *   Data members of the Graph class here!
+    *
+    *   Everything about a graph is accessible via
+    *    these three data structures!
+    ***************************************************/
+
+    // _names:
+    // Each vertex in a graph is identified in two ways:
+    //      - by its unique 'name' which is a string (so things are
+    //        friendly to the outside world).
+    //      - by its unique integer ID which is more convenient 
+    //        internally.  If a graph has N vertices, the 
+    //        corresponding IDs are ALWAYS 0..N-1.
+    // _names is a name_arena (see above):  it stores the name of
+    //       every vertex (indexed by ID) and lets us easily retrieve
+    //       the vertex ID associated with a given vertex name.
+    name_arena _names;
+
+    // vertices:
+    //   vertices is the primary data structure:  it is an  implementation
+    //      of a pretty standard adjacency list.
+    //   It is indexed by vertex ID.
+    //   vertices[u] contains everything we need to know about vertex u:
+    //       - name (string)
+    //       - ID (int).  Somewhat redundant since vertices[u].id == u
+    //         (or -1 once u is removed)
+    //       - outgoing edges (as a vector of edge structures)
+    //       - incoming edges (as a vector of edge structures)
+    //       
+    //   See struct vertex above
+    vector<vertex> vertices;
+
+    // the edge set edges isn't going to be of much interest
+    //   to you.  Its main purpose is to detect duplicate edges
+    //   while building a graph (see add_edge)..
+    // Notes:  the data structure is an edge_set (see above) which is
+    //   really a hash table keyed on the (src-ID, dest-ID) pair of
+    //   already added edges; it allows add_edge to detect if an edge
+    //   already exists efficiently.
+    edge_set edges;
+
+    // csr:
+    //   compressed sparse row (CSR) snapshot of the adjacency lists.
+    //   The per-vertex outgoing/incoming vectors are convenient while a
+    //   graph is being built, but every vertex owns two separate heap
+    //   blocks, so a traversal chases a pointer per vertex.  The
+    //   snapshot packs the same information into flat arrays:
+    //
+    //       the outgoing edges of u are at positions
+    //           out_off[u] .. out_off[u+1]-1
+    //       of out_tgt (destination IDs) and out_wt (weights), in the
+    //       same order as vertices[u].outgoing.
+    //
+    //       in_off/in_tgt/in_wt are the same thing for incoming edges.
+    //
+    //   All of the algorithms below read the snapshot (see snapshot()).
+    //   It is rebuilt lazily after add_edge changes the graph.
+    //
+    //   The arrays are flat_arrays so that a snapshot can also point
+    //   straight into a memory-mapped binary graph file (see
+    //   read_binary); _mapping keeps such a file mapped.
+    struct csr {
+      flat_array<int> out_off;
+      flat_array<int> out_tgt;
+      flat_array<double> out_wt;
+      flat_array<int> in_off;
+      flat_array<int> in_tgt;
+      flat_array<double> in_wt;
+    };
+
+    csr _csr;
+    bool _csr_valid = false;  // _csr reflects the current edges
+    bool _frozen = false;     // per-vertex edge vectors released (see freeze)
+    std::shared_ptr<mapped_file> _mapping;
+
+    // packed_adj:
+    //   compressed outgoing lists, which replace the snapshot once the
+    //   graph is compress()ed.  Each list is sorted by neighbor ID and
+    //   stored as the differences between consecutive IDs -- the first
+    //   one relative to the vertex itself, zigzag encoded since it may
+    //   be negative -- each as a varint:  7 bits per byte, the high bit
+    //   set on every byte but the last.  Once the graph is reordered
+    //   (see rcm_order) most differences take a single byte.
+    //
+    //       the list of u is bytes[off[u] .. off[u+1]-1]
+    //
+    //   There are no incoming lists:  what needs in-degrees (topo_sort)
+    //   counts them on the fly.
+    //
+    //   The weights, in list order, depend on wbytes:
+    //       0:     every edge has weight wtab[0] (e.g., unweighted graphs)
+    //       1, 2:  wdata holds 1 or 2 byte indexes into wtab, the
+    //              table of distinct weights (exact)
+    //       4:     wdata holds the weights as floats (rounded to about
+    //              7 significant digits)
+    struct packed_adj {
+      vector<uint64_t> off;
+      vector<unsigned char> bytes;
+      vector<unsigned char> wdata;
+      vector<double> wtab;
+      int wbytes = 0;
+      uint64_t m = 0;
+      vector<int> indeg;      // counted the first time in_degree asks
+
+      static void put(vector<unsigned char> &b, uint64_t x) {
+        for( ; x >= 0x80; x >>= 7)
+          b.push_back((unsigned char)(x | 0x80));
+        b.push_back((unsigned char)x);
+      }
+
+      // decodes the varint at bytes[pos] and advances pos past it
+      uint64_t get(uint64_t &pos) const {
+        uint64_t x = bytes[pos++];
+        int shift = 7;
+
+        if(x < 0x80)
+          return x;
+        x &= 0x7f;
+        for( ; ; shift += 7) {
+          uint64_t b = bytes[pos++];
+          x |= (b & 0x7f) << shift;
+          if(b < 0x80)
+            return x;
+        }
+      }
+
+      // decodes the neighbor of u at bytes[pos] (advancing pos); prev
+      //   is the neighbor before it in the list (unused for the first)
+      int next(int u, uint64_t &pos, int prev) const {
+        if(pos == off[u]) {
+          uint64_t z = get(pos);
+          return u + (int)((int64_t)(z >> 1) ^ -(int64_t)(z & 1));
+        }
+        return prev + (int)get(pos);
+      }
+
+      // weight of the i-th edge (counting through all lists in order)
+      double weight(uint64_t i) const {
+        float f;
+
+        switch(wbytes) {
+          case 0:
+            return wtab[0];
+          case 1:
+            return wtab[wdata[i]];
+          case 2:
+            return wtab[wdata[2*i] | (wdata[2*i+1] << 8)];
+        }
+        memcpy(&f, &wdata[4*i], sizeof(f));
+        return f;
+      }
+
+      size_t bytes_used() const {
+        return off.capacity()*sizeof(uint64_t) + bytes.capacity() +
+          wdata.capacity() + wtab.capacity()*sizeof(double) +
+          indeg.capacity()*sizeof(int);
+      }
+    };
+
+    packed_adj _packed;
+    bool _compressed = false; // _packed replaces _csr (see compress)
+    bool _uncompress_warned = false;
+
+    // work stack for dfs:  (vertex, index of next outgoing edge to
+    //   examine) pairs.  Kept between runs so that repeated searches
+    //   don't reallocate it.
+    vector<std::pair<int, int> > _dfs_stack;
+
+    // the same for a compressed graph:  (vertex, position of its next
+    //   neighbor in the compressed list, the neighbor before that)
+    struct packed_frame {
+      int u;
+      int prev;
+      uint64_t pos;
+    };
+    vector<packed_frame> _packed_stack;
+
+    // cached result of the last DAG check (see dag_order):
+    //   _dag_status is '?' (not known), 'y' (graph is a DAG; _topo_order
+    //   is a topological order) or 'n' (graph has a cycle).
+    //   Reset to '?' whenever the graph changes.
+    char _dag_status = '?';
+    vector<int> _topo_order;
+
+    // topological levels of a DAG (see dag_levels), cached like
+    //   _topo_order:  the vertices at level L are
+    //   _level_vtx[_level_off[L] .. _level_off[L+1]-1].
+    //   Empty when not computed.
+    vector<int> _level_off;
+    vector<int> _level_vtx;
+
+    // threads for the parallel algorithms; started on first use
+    //   (see pool())
+    std::shared_ptr<worker_pool> _pool;
+
+    // labels of the forward (side 0) and backward (side 1) searches of
+    //   bidir_bfs and bidir_dijkstra.  A label is valid only if its
+    //   seen[] entry equals round, so starting a new query is O(1)
+    //   instead of O(V) and a query only touches what it explores.
+    struct bidir_labels {
+      vector<unsigned> seen[2];
+      vector<unsigned> done[2];
+      vector<double> dist[2];
+      vector<int> pred[2];
+      unsigned round = 0;
+
+      void start(int n) {
+        int s;
+        if((int)seen[0].size() != n || ++round == 0) {
+          for(s=0; s<2; s++) {
+            seen[s].assign(n, 0);
+            done[s].assign(n, 0);
+            dist[s].resize(n);
+            pred[s].resize(n);
+          }
+          round = 1;
+        }
+      }
+      bool reached(int s, int v) const { return seen[s][v] == round; }
+      bool settled(int s, int v) const { return done[s][v] == round; }
+      void reach(int s, int v, double d, int p) {
+        seen[s][v] = round;
+        dist[s][v] = d;
+        pred[s][v] = p;
+      }
+    };
+    bidir_labels _bidir;
+
+    // _orig_id[u]:  the ID vertex u had before the graph was first
+    //   reordered or compacted (empty if it never was; see reorder
+    //   and compact); the original IDs are 0.._orig_n-1, and a vertex
+    //   added since gets the next one.  _relabels counts reorderings
+    //   and removals, so that structures built over the graph
+    //   (alt_index, ch_index, reach_index, dynamic_topo) can tell that
+    //   their vertex IDs or edges are stale even when the vertex and
+    //   edge counts happen to match.
+    vector<int> _orig_id;
+    int _orig_n = 0;
+    unsigned _relabels = 0;
+
+    // removals (see remove_edge):  _dead_entries counts the tombstones
+    //   in the per-vertex lists and _dead_vertices the removed
+    //   vertices.  When either is more than _compact_ratio of the
+    //   whole, the graph is compacted; _on_compact is told of the new
+    //   vertex IDs.
+    size_t _dead_entries = 0;
+    int _dead_vertices = 0;
+    double _compact_ratio = 0.25;
+    std::function<void(const vector<int> &)> _on_compact;
+
+  public:
+
+    // this struct is used for capturing the results of an operation.
+    // typically a "report" will be a vector of vertex_labels indexed
+    // by vertex-id.
+    struct vertex_label {
+      double dist; //distance
+      int pred; // predecessor 
+      char state;
+      long long npaths;
+      
+      vertex_label( double _dist=0.0, int _pred=-1, char _state='?',
+          long long _npaths=0) 
+        : dist { _dist }, pred { _pred }, state { _state}, npaths { 0 }
+      { }
+
+    };
+
+    // discovery and finish "times" of a depth-first search:  a clock
+    //   starts at 0 and is advanced every time a vertex is discovered
+    //   (becomes ACTIVE) or finished.  Indexed by vertex ID; -1 for
+    //   vertices the search never reached.
+    struct dfs_times {
+      vector<int> discovery;
+      vector<int> finish;
+    };
+
+
+    graph() {}
+
+    ~graph() {}
+
+  private:
+
+    /*
+     * function:  vertex_id
+     * desc:  returns the ID of the named vertex, adding the vertex
+     *   to the graph first if it is not already there.  A removed
+     *   vertex that has not been compacted away yet comes back (with
+     *   no edges) under its old ID.
+     *
+     *   Only one hash table lookup is done either way.
+     */
+    int vertex_id(const char *name, size_t len) {
+      bool added;
+      int id = _names.insert(name, len, added);
+
+      if(added) {
+        vertices.push_back(vertex(id));
+        if(!_orig_id.empty())
+          _orig_id.push_back(_orig_n++);
+      }
+      else if(_dead_vertices > 0 && vertices[id].id == -1) {
+        vertices[id].id = id;
+        _dead_vertices--;
+      }
+      return id;
+    }
+    int vertex_id(const string &name) {
+      return vertex_id(name.data(), name.size());
+    }
+
+    /*
+     * function:  build_csr
+     * desc:  (re)builds the CSR snapshot from the per-vertex
+     *   outgoing and incoming vectors, leaving out tombstones.  So the
+     *   algorithms, which all read the snapshot, never see a removed
+     *   edge.  O(V+E).
+     */
+    void build_csr() {
+      int u, n = vertices.size();
+
+      _csr.out_off.assign(n+1, 0);
+      _csr.in_off.assign(n+1, 0);
+      for(u=0; u<n; u++) {
+        _csr.out_off[u+1] = _csr.out_off[u] + live_size(vertices[u].outgoing);
+        _csr.in_off[u+1] = _csr.in_off[u] + live_size(vertices[u].incoming);
+      }
+      _csr.out_tgt.resize(_csr.out_off[n]);
+      _csr.out_wt.resize(_csr.out_off[n]);
+      _csr.in_tgt.resize(_csr.in_off[n]);
+      _csr.in_wt.resize(_csr.in_off[n]);
+
+      for(u=0; u<n; u++) {
+        int i = _csr.out_off[u];
+        for(edge &e : vertices[u].outgoing) {
+          if(e.vertex_id == -1)
+            continue;
+          _csr.out_tgt[i] = e.vertex_id;
+          _csr.out_wt[i++] = e.weight;
+        }
+        i = _csr.in_off[u];
+        for(edge &e : vertices[u].incoming) {
+          if(e.vertex_id == -1)
+            continue;
+          _csr.in_tgt[i] = e.vertex_id;
+          _csr.in_wt[i++] = e.weight;
+        }
+      }
+      _csr_valid = true;
+      _mapping.reset();
+    }
+
+    // entries of an adjacency list that are not tombstones
+    size_t live_size(const vector<edge> &list) const {
+      if(_dead_entries == 0)
+        return list.size();
+      return std::count_if(list.begin(), list.end(),
+          [](const edge &e) { return e.vertex_id != -1; });
+    }
+
+    /*
+     * function:  snapshot
+     * desc:  returns the CSR snapshot, building it first if the
+     *   graph has changed since it was last built.
+     *
+     *   A compressed graph is uncompressed (and stays that way), which
+     *   gives back the memory compress saved; a warning says so the
+     *   first time it happens.
+     */
+    const csr & snapshot() {
+      if(_compressed) {
+        if(!_uncompress_warned) {
+          std::cerr << "warning: uncompressing the graph (call compress() "
+            "again to re-compress it)\n";
+          _uncompress_warned = true;
+        }
+        uncompress();
+      }
+      else if(!_csr_valid)
+        build_csr();
+      return _csr;
+    }
+
+    /*
+     * function:  uncompress
+     * desc:  undoes compress():  rebuilds the (frozen) CSR snapshot,
+     *   incoming lists included, from the compressed lists.  The
+     *   outgoing lists come back sorted by neighbor ID.  O(V+E).
+     */
+    void uncompress() {
+      int u, v, n = num_nodes();
+      uint64_t pos, i = 0;
+
+      _csr.out_off.resize(n+1);
+      _csr.out_tgt.resize(_packed.m);
+      _csr.out_wt.resize(_packed.m);
+      _csr.in_off.assign(n+1, 0);
+      _csr.in_tgt.resize(_packed.m);
+      _csr.in_wt.resize(_packed.m);
+
+      _csr.out_off[0] = 0;
+      for(u=0; u<n; u++) {
+        for(pos=_packed.off[u], v=u; pos<_packed.off[u+1]; i++) {
+          v = _packed.next(u, pos, v);
+          _csr.out_tgt[i] = v;
+          _csr.out_wt[i] = _packed.weight(i);
+          _csr.in_off[v+1]++;
+        }
+        _csr.out_off[u+1] = i;
+      }
+
+      // incoming lists:  counting sort of the edges by destination
+      for(u=0; u<n; u++)
+        _csr.in_off[u+1] += _csr.in_off[u];
+      for(u=0; u<n; u++) {
+        for(i=_csr.out_off[u]; i<(uint64_t)_csr.out_off[u+1]; i++) {
+          v = _csr.out_tgt[i];
+          _csr.in_tgt[_csr.in_off[v]] = u;
+          _csr.in_wt[_csr.in_off[v]++] = _csr.out_wt[i];
+        }
+      }
+      for(u=n; u>0; u--)
+        _csr.in_off[u] = _csr.in_off[u-1];
+      _csr.in_off[0] = 0;
+
+      _packed = packed_adj();
+      _compressed = false;
+      _csr_valid = true;
+    }
+
+    /*
+     * function:  ready_adjacency
+     * desc:  makes sure the outgoing lists can be read through
+     *   for_each_out:  the compressed lists if the graph is compressed,
+     *   otherwise the snapshot (built if necessary).
+     */
+    void ready_adjacency() {
+      if(!_compressed)
+        snapshot();
+    }
+
+    /*
+     * function:  for_each_out
+     * desc:  calls f(v) for every outgoing neighbor v of u, decoding
+     *   the compressed list on the fly if the graph is compressed.
+     *   Call ready_adjacency first.
+     */
+    template <typename F>
+    void for_each_out(int u, const F &f) const {
+      int i, v;
+      uint64_t pos;
+
+      if(_compressed) {
+        for(pos=_packed.off[u], v=u; pos<_packed.off[u+1]; )
+          f(v = _packed.next(u, pos, v));
+      }
+      else {
+        for(i=_csr.out_off[u]; i<_csr.out_off[u+1]; i++)
+          f(_csr.out_tgt[i]);
+      }
+    }
+
+    /*
+     * function:  pool
+     * desc:  returns a worker_pool with nthreads threads (nthreads <= 0
+     *   means one per hardware thread), reusing the graph's pool when
+     *   it already has that many.
+     */
+    worker_pool & pool(int nthreads) {
+      if(nthreads <= 0)
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+      if(!_pool || _pool->size() != nthreads)
+        _pool.reset(new worker_pool(nthreads));
+      return *_pool;
+    }
+
+    /*
+     * function:  write_section
+     * desc:  helper for write_binary:  pads the file with zeros up
+     *   to the next multiple of 8 bytes, then writes len bytes of data.
+     *   pos tracks the current file position.  Returns the offset at
+     *   which the data starts.
+     */
+    static uint64_t write_section(std::ofstream &file, uint64_t &pos,
+        const void *data, uint64_t len) {
+      static const char zeros[8] = { 0 };
+      uint64_t start = (pos + 7) & ~(uint64_t)7;
+
+      file.write(zeros, start - pos);
+      file.write((const char *)data, len);
+      pos = start + len;
+      return start;
+    }
+
+    /*
+     * function:  thaw
+     * desc:  undoes freeze():  rebuilds the per-vertex edge vectors
+     *   from the snapshot so that the graph can be modified again.
+     */
+    void thaw() {
+      int u, i;
+
+      if(_compressed)
+        uncompress();
+      for(u=0; u<(int)vertices.size(); u++) {
+        vertices[u].outgoing.clear();
+        vertices[u].incoming.clear();
+        for(i=_csr.out_off[u]; i<_csr.out_off[u+1]; i++)
+          vertices[u].outgoing.push_back(edge(_csr.out_tgt[i], _csr.out_wt[i]));
+        for(i=_csr.in_off[u]; i<_csr.in_off[u+1]; i++)
+          vertices[u].incoming.push_back(edge(_csr.in_tgt[i], _csr.in_wt[i]));
+      }
+
+      // a graph loaded by read_binary has no duplicate-edge index yet
+      if(edges.size() != _csr.out_tgt.size()) {
+        edges.clear();
+        edges.reserve(_csr.out_tgt.size());
+        for(u=0; u<(int)vertices.size(); u++) {
+          for(i=_csr.out_off[u]; i<_csr.out_off[u+1]; i++)
+            edges.insert(u, _csr.out_tgt[i]);
+        }
+      }
+      _frozen = false;
+    }
+
+
+
+    /*
+     * function: p_edge
+     * desc:  simple function for printing an edge
+     */
+    void p_edge(edge &e) {
+      std::cout << "(" << id2name(e.vertex_id) 
+        << ", " << e.weight << ") ";
+    }
+
+  public:
+
+    /*
+     * func:  id2name
+     * desc:  returns vertex name associated with given vertex id, as
+     *         a name_view into the graph's name arena (no copy; see
+     *         name_view -- it converts to a string).
+     *
+     *         If id not valid for given graph, the string "$NONE$"
+     *         is returned.
+     */
+    name_view id2name(int id) {
+      if(id<0 || id>=vertices.size())
+        return name_view("$NONE$", 6);
+      return _names.get(id);
+    }
+
+    /*
+     * func: name2id
+     * desc: returns integer vertex id of given vertex name.
+     *       If there is no such vertex in the graph (or it has been
+     *       removed), -1 is returned.
+     */
+    int name2id(const string &vtx_name) {
+      int id = _names.find(vtx_name.data(), vtx_name.size());
+
+      if(id != -1 && vertices[id].id == -1)
+        return -1;      // removed
+      return id;
+    }
+
+    // bytes used by the vertex names and the name index
+    size_t name_bytes() {
+      return _names.bytes();
+    }
+
+    /*
+     * func: name_vec2string
+     * desc: utility function - if you have a bunch of
+     *   vertex names (as strings) stored in a vector, this
+     *   function puts the names in a single string with
+     *   nodes separated by single spaces.
+     *
+     *   Might be handy for things like getting an easy to
+     *   print representation of a path for example.
+     */
+    string name_vec2string(const vector<string> &vec) {
+      string s = "";
+      int i;
+
+      if(vec.size()==0)
+        return s;
+
+      s = s + vec[0];
+      for(i = 1; i<vec.size(); i++) {
+        s = s + " " + vec[i];
+      }
+      return s;
+    }
+
+    /*
+     * func: id_vec2string
+     * desc: utility function - if you have a bunch of
+     *   vertex ids (ints) stored in a vector, this
+     *   function connverts them to names and builds a in a 
+     *   single string with nodes-names separated by single spaces.
+     *
+     *   Might be handy for things like getting an easy to
+     *   print representation of a path for example.
+     */
+    string id_vec2string(const vector<int> &vec) {
+      string s = "";
+      int i;
+
+      if(vec.size()==0)
+        return s;
+
+      s = s + id2name(vec[0]);
+      for(i = 1; i<vec.size(); i++) {
+        s = s + " " + id2name(vec[i]);
+      }
+      return s;
+    }
+
+
+
+
+    /*
+     * func: add_edge
+     * desc: adds edge (src,dest) with given weight to graph if
+     *   possible.
+     *
+     *       If edge (src,dest) is already in graph, the graph is
+     *       unchanged and false is returned.
+     *
+     *       Otherwise the edge is added and true is returned.
+     *
+     *       Note:  if src and/or dest are not currently vertices
+     *         in the graph, they will be added.
+     */
+    bool add_edge(const string &src, const string &dest, 
+        double weight=1.0) {
+
+      int s_id, d_id;
+
+      if(_frozen)
+        thaw();
+
+      // get ids for source and destination vertices (adding
+      //   them if necessary)
+      s_id = vertex_id(src);
+      d_id = vertex_id(dest);
+
+      return insert_edge(s_id, d_id, weight);
+    }
+
+  private:
+    /*
+     * func: insert_edge
+     * desc: the "real work" of add_edge once both endpoints have
+     *   vertex IDs:  checks for a duplicate and then appends the
+     *   edge to the adjacency lists.  Graph must not be frozen.
+     */
+    bool insert_edge(int s_id, int d_id, double weight) {
+
+      if(!edges.insert(s_id, d_id)) {
+        std::cerr << "warning: duplicate edge '"
+          << id2name(s_id) << " " << id2name(d_id) << "'\n";
+        return false;
+      }
+
+      vertices[s_id].outgoing.push_back(edge(d_id, weight));
+      vertices[d_id].incoming.push_back(edge(s_id, weight));
+      _csr_valid = false;
+      dag_changed();
+
+      return true;
+    }
+
+    // an edge while insert_edges sorts it into place:  the vertex at
+    //   its other end, its position in the input and its weight
+    struct bulk_edge {
+      int other;
+      int e;
+      double weight;
+    };
+
+    /*
+     * func: group_edges
+     * desc: helper for insert_edges:  stable sort of items by vertex,
+     *   key[i] (< n) being the vertex of items[i].  Afterwards the
+     *   items of vertex u are items[off[u] .. off[u+1]-1], still in
+     *   their original order.
+     *
+     *   A counting sort done in two passes so that its writes stay
+     *   within the cache:  the first pass (parallel over pieces of the
+     *   input) splits the items among at most 1024 ranges of
+     *   consecutive vertices; the second (parallel over the ranges)
+     *   sorts each range, which is small, by vertex.
+     */
+    static void group_edges(worker_pool &wp, int n, const vector<int> &key,
+        vector<bulk_edge> &items, vector<int> &off) {
+      size_t k = items.size(), sum = 0, c;
+      int nt = wp.size(), shift = 0, np, p, t;
+      vector<bulk_edge> tmp(k);
+      vector<int> tmp_key(k);
+      vector<size_t> pstart;
+      vector<vector<size_t> > cur(nt);
+
+      while((n >> shift) >= 1024)
+        shift++;
+      np = (n >> shift) + 1;
+
+      // pass 1:  cur[t][p] counts the items of range p in piece t of
+      //   the input, and then is the cursor where piece t puts them
+      wp.run([&](int tid) {
+        size_t i, hi = k*(tid+1)/nt;
+        cur[tid].assign(np, 0);
+        for(i=k*tid/nt; i<hi; i++)
+          cur[tid][key[i] >> shift]++;
+      });
+      pstart.resize(np+1);
+      for(p=0; p<np; p++) {
+        pstart[p] = sum;
+        for(t=0; t<nt; t++) {
+          c = cur[t][p];
+          cur[t][p] = sum;
+          sum += c;
+        }
+      }
+      pstart[np] = sum;
+      wp.run([&](int tid) {
+        size_t i, j, hi = k*(tid+1)/nt;
+        for(i=k*tid/nt; i<hi; i++) {
+          j = cur[tid][key[i] >> shift]++;
+          tmp[j] = items[i];
+          tmp_key[j] = key[i];
+        }
+      });
+
+      // pass 2
+      off.resize(n+1);
+      off[n] = k;
+      wp.for_blocks(np, [&](size_t lo, size_t hi, int /*tid*/) {
+        vector<int> cnt;
+        size_t i;
+        int u, u0, u1;
+
+        for(size_t q=lo; q<hi; q++) {
+          u0 = q << shift;
+          u1 = std::min(n, u0 + (1 << shift));
+          if(u0 >= n)
+            continue;
+          cnt.assign(u1-u0+1, 0);
+          for(i=pstart[q]; i<pstart[q+1]; i++)
+            cnt[tmp_key[i]-u0+1]++;
+          cnt[0] = pstart[q];
+          for(u=u0; u<u1; u++) {
+            cnt[u-u0+1] += cnt[u-u0];
+            off[u] = cnt[u-u0];
+          }
+          for(i=pstart[q]; i<pstart[q+1]; i++)
+            items[cnt[tmp_key[i]-u0]++] = tmp[i];
+        }
+      }, 1);
+    }
+
+    /*
+     * func: insert_edges
+     * desc: the "real work" of add_edges:  adds edges
+     *   (src[e], dest[e], wt[e]) -- all vertices must exist -- with the
+     *   same result as calling insert_edge on each e in order, but
+     *   building the CSR snapshot directly:
+     *
+     *     1. the new edges are grouped by source (group_edges);
+     *     2. per source, they are sorted by (destination, e):  copies
+     *        of an edge are now adjacent and only the first is kept;
+     *        the others, and edges the graph already has, are dropped.
+     *        The rest are put back in input order;
+     *     3. the outgoing lists are laid out:  each vertex's existing
+     *        edges followed by its new ones;
+     *     4. the incoming lists likewise, after grouping the kept
+     *        edges by destination.
+     *
+     *   Each step is a parallel pass over the edges or the vertices
+     *   that moves the edges themselves rather than indexes to them, so
+     *   there is little random access, and there is no per-edge
+     *   allocation or hashing.  The graph is left frozen (see freeze).
+     *   Not for compressed graphs.
+     *
+     * returns the number of edges added.
+     */
+    int insert_edges(const vector<int> &src, const vector<int> &dest,
+        const vector<double> &wt, int nthreads) {
+      vector<int> off, in_off, kept, in_key;
+      vector<bulk_edge> items(src.size()), in_items;
+      vector<char> dup(src.size(), 0);
+      csr nc;
+      size_t e, k = src.size();
+      int u, n = num_nodes(), n_old, nadded = 0;
+      worker_pool &wp = pool(nthreads);
+      auto by_e = [](const bulk_edge &a, const bulk_edge &b) {
+        return a.e < b.e;
+      };
+
+      // existing edges; vertices added since have none
+      const csr &c = snapshot();
+      n_old = c.out_off.size() - 1;
+      auto old_out = [&](int v) {
+        return v < n_old ? c.out_off[v+1] - c.out_off[v] : 0;
+      };
+      auto old_in = [&](int v) {
+        return v < n_old ? c.in_off[v+1] - c.in_off[v] : 0;
+      };
+
+      // 1:  group by source
+      wp.for_blocks(k, [&](size_t lo, size_t hi, int /*tid*/) {
+        for(size_t i=lo; i<hi; i++)
+          items[i] = bulk_edge { dest[i], (int)i, wt[i] };
+      }, 1<<16);
+      group_edges(wp, n, src, items, off);
+
+      // 2:  drop duplicates; the kept edges of v end up (in input
+      //   order) at the start of its bucket
+      kept.assign(n, 0);
+      wp.for_blocks(n, [&](size_t lo, size_t hi, int /*tid*/) {
+        vector<int> have;
+        int i, last;
+
+        for(size_t v=lo; v<hi; v++) {
+          auto first = items.begin() + off[v], end = items.begin() + off[v+1];
+          auto out = first;
+
+          if(first == end)
+            continue;
+          std::sort(first, end, [](const bulk_edge &a, const bulk_edge &b) {
+            return a.other < b.other || (a.other == b.other && a.e < b.e);
+          });
+          have.clear();
+          for(i=0; i<old_out(v); i++)
+            have.push_back(c.out_tgt[c.out_off[v] + i]);
+          std::sort(have.begin(), have.end());
+
+          for(last=-1; first != end; ++first) {
+            if(first->other == last ||
+                std::binary_search(have.begin(), have.end(), first->other))
+              dup[first->e] = 1;
+            else
+              *out++ = *first;
+            last = first->other;
+          }
+          first = items.begin() + off[v];
+          kept[v] = out - first;
+          std::sort(first, out, by_e);
+        }
+      }, 1024);
+
+      // 3:  outgoing lists
+      nc.out_off.resize(n+1);
+      nc.out_off[0] = 0;
+      for(u=0; u<n; u++)
+        nc.out_off[u+1] = nc.out_off[u] + old_out(u) + kept[u];
+      nc.out_tgt.resize(nc.out_off[n]);
+      nc.out_wt.resize(nc.out_off[n]);
+      wp.for_blocks(n, [&](size_t lo, size_t hi, int /*tid*/) {
+        for(size_t v=lo; v<hi; v++) {
+          int i, j = nc.out_off[v];
+          for(i=0; i<old_out(v); i++, j++) {
+            nc.out_tgt[j] = c.out_tgt[c.out_off[v] + i];
+            nc.out_wt[j] = c.out_wt[c.out_off[v] + i];
+          }
+          for(i=off[v]; i<off[v]+kept[v]; i++, j++) {
+            nc.out_tgt[j] = items[i].other;
+            nc.out_wt[j] = items[i].weight;
+          }
+        }
+      }, 4096);
+
+      // 4:  the kept edges, grouped by destination; incoming lists.
+      //   (kept[v] becomes the position of v's first kept edge in
+      //   in_items.)
+      for(u=0, e=0; u<n; u++) {
+        int cnt = kept[u];
+        kept[u] = e;
+        e += cnt;
+      }
+      in_items.resize(e);
+      in_key.resize(e);
+      wp.for_blocks(n, [&](size_t lo, size_t hi, int /*tid*/) {
+        for(int v=(int)lo; v<(int)hi; v++) {
+          int i, j = kept[v], end = v+1 < n ? kept[v+1] : in_items.size();
+          for(i=off[v]; j < end; i++, j++) {
+            in_items[j] = bulk_edge { v, items[i].e, items[i].weight };
+            in_key[j] = items[i].other;
+          }
+        }
+      }, 4096);
+      vector<bulk_edge>().swap(items);
+      group_edges(wp, n, in_key, in_items, in_off);
+
+      nc.in_off.resize(n+1);
+      nc.in_off[0] = 0;
+      for(u=0; u<n; u++)
+        nc.in_off[u+1] = nc.in_off[u] + old_in(u) + in_off[u+1] - in_off[u];
+      nc.in_tgt.resize(nc.in_off[n]);
+      nc.in_wt.resize(nc.in_off[n]);
+      wp.for_blocks(n, [&](size_t lo, size_t hi, int /*tid*/) {
+        for(size_t v=lo; v<hi; v++) {
+          int i, j = nc.in_off[v];
+          std::sort(in_items.begin() + in_off[v], in_items.begin() + in_off[v+1], by_e);
+          for(i=0; i<old_in(v); i++, j++) {
+            nc.in_tgt[j] = c.in_tgt[c.in_off[v] + i];
+            nc.in_wt[j] = c.in_wt[c.in_off[v] + i];
+          }
+          for(i=in_off[v]; i<in_off[v+1]; i++, j++) {
+            nc.in_tgt[j] = in_items[i].other;
+            nc.in_wt[j] = in_items[i].weight;
+          }
+        }
+      }, 4096);
+
+      for(e=0; e<k; e++) {
+        if(!dup[e])
+          nadded++;
+        else {
+          std::cerr << "warning: duplicate edge '"
+            << id2name(src[e]) << " " << id2name(dest[e]) << "'\n";
+        }
+      }
+
+      if(!_frozen) {
+        for(vertex &vtx : vertices) {
+          vector<edge>().swap(vtx.outgoing);
+          vector<edge>().swap(vtx.incoming);
+        }
+        _dead_entries = 0;
+      }
+      _csr.out_off.swap(nc.out_off);
+      _csr.out_tgt.swap(nc.out_tgt);
+      _csr.out_wt.swap(nc.out_wt);
+      _csr.in_off.swap(nc.in_off);
+      _csr.in_tgt.swap(nc.in_tgt);
+      _csr.in_wt.swap(nc.in_wt);
+      _csr_valid = true;
+      _frozen = true;
+      _mapping.reset();
+      edges.clear();
+      dag_changed();
+      return nadded;
+    }
+
+  public:
+
+    /*
+     * func: add_edges
+     * desc: adds a batch of edges at once.  Each element of the range
+     *   [first, last) is a (src, dest, weight) tuple -- anything
+     *   std::get<0>, <1> and <2> work on, such as
+     *   std::tuple<string, string, double>.
+     *
+     *   The result is the same as calling add_edge on the elements in
+     *   order (the first copy of a repeated edge is kept, and the
+     *   others are reported as duplicates), but large batches go much
+     *   faster:  the vertex names are resolved in one pass and then the
+     *   adjacency lists are built with parallel counting sorts instead
+     *   of one push_back and one duplicate check per edge (see
+     *   insert_edges).  nthreads is as for the parallel algorithms
+     *   (<= 0:  one per hardware thread).
+     *
+     *   The graph is left frozen (see freeze); a compressed graph is
+     *   compressed again afterwards.
+     *
+     * returns the number of edges added.
+     */
+    template <typename It>
+    int add_edges(It first, It last, int nthreads=0) {
+      vector<int> src, dest;
+      vector<double> wt;
+      bool was_compressed = _compressed;
+      int nadded;
+
+      // (before any vertices are added)
+      if(_compressed)
+        uncompress();
+      for( ; first != last; ++first) {
+        src.push_back(vertex_id(std::get<0>(*first)));
+        dest.push_back(vertex_id(std::get<1>(*first)));
+        wt.push_back(std::get<2>(*first));
+      }
+      nadded = insert_edges(src, dest, wt, nthreads);
+      if(was_compressed)
+        compress();
+      return nadded;
+    }
+
+    int add_edges(const vector<std::tuple<string, string, double> > &batch,
+        int nthreads=0) {
+      return add_edges(batch.begin(), batch.end(), nthreads);
+    }
+
+    /*
+     * func: remove_edge
+     * desc: removes edge (src,dest) from the graph.
+     *
+     *   The edge's entries in the outgoing list of src and the
+     *   incoming list of dest become tombstones -- nothing is moved,
+     *   so the lists keep their order -- and the edge leaves the
+     *   duplicate-edge index, so it can be added again later.
+     *
+     *   Like add_edge, it thaws a frozen (or compressed) graph first.
+     *   The CSR snapshot is rebuilt without the tombstones the next
+     *   time an algorithm runs, so traversals never see them.  Once
+     *   they make up too much of the lists (see compact_ratio) the
+     *   graph compacts itself.
+     *
+     * returns false (graph unchanged) if there is no such edge.
+     *
+     * RUNTIME:  O(out_degree(src) + in_degree(dest)) to find the
+     *   entries
+     */
+    bool remove_edge(const string &src, const string &dest) {
+      int s_id = name2id(src), d_id = name2id(dest);
+
+      if(s_id == -1 || d_id == -1)
+        return false;
+      if(_frozen)
+        thaw();
+      if(!erase_edge(s_id, d_id))
+        return false;
+      removed();
+      return true;
+    }
+
+    /*
+     * func: remove_vertex
+     * desc: removes the named vertex along with its edges (which
+     *   leave tombstones in the lists of its neighbors, as in
+     *   remove_edge).
+     *
+     *   IDs are not renumbered right away:  until the graph is
+     *   compacted the vertex keeps its ID, with no edges, but name2id
+     *   no longer finds it and is_removed is true.  topo_sort,
+     *   display and disp_report leave such vertices out; other
+     *   results indexed by ID still have an entry for each (scc, for
+     *   one, puts each in a component of its own), so call compact
+     *   first where that matters.  Adding an edge with the name
+     *   brings the vertex back.
+     *
+     *   Compaction -- automatic once removed vertices are too large a
+     *   fraction of all (see compact_ratio) -- numbers the remaining
+     *   vertices 0..V-1 again and reports the new IDs (see on_compact).
+     *
+     * returns false if there is no such vertex.
+     *
+     * RUNTIME:  O(sum of the degrees of its neighbors)
+     */
+    bool remove_vertex(const string &name) {
+      int u = name2id(name), v;
+
+      if(u == -1)
+        return false;
+      if(_frozen)
+        thaw();
+
+      vertex &vtx = vertices[u];
+      for(edge &e : vtx.outgoing) {
+        v = e.vertex_id;
+        if(v == -1)
+          _dead_entries--;     // goes away with the list
+        else {
+          edges.erase(u, v);
+          if(v != u)
+            kill_entry(vertices[v].incoming, u);
+        }
+      }
+      for(edge &e : vtx.incoming) {
+        v = e.vertex_id;
+        if(v == -1)
+          _dead_entries--;
+        else if(v != u) {
+          edges.erase(v, u);
+          kill_entry(vertices[v].outgoing, u);
+        }
+      }
+      vector<edge>().swap(vtx.outgoing);
+      vector<edge>().swap(vtx.incoming);
+      vtx.id = -1;
+      _dead_vertices++;
+      removed();
+      return true;
+    }
+
+  private:
+    // turns the entry for vertex v in list into a tombstone
+    void kill_entry(vector<edge> &list, int v) {
+      for(edge &e : list) {
+        if(e.vertex_id == v) {
+          e.vertex_id = -1;
+          _dead_entries++;
+          return;
+        }
+      }
+    }
+
+    /*
+     * func: erase_edge
+     * desc: the "real work" of remove_edge:  takes edge (s_id, d_id)
+     *   out of the edge index and leaves tombstones for it.  Graph
+     *   must not be frozen.  Returns false if there is no such edge.
+     */
+    bool erase_edge(int s_id, int d_id) {
+      if(!edges.erase(s_id, d_id))
+        return false;
+      kill_entry(vertices[s_id].outgoing, d_id);
+      kill_entry(vertices[d_id].incoming, s_id);
+      return true;
+    }
+
+    // bookkeeping after a removal, and compaction if it is due
+    //   (see compact_ratio)
+    void removed() {
+      _csr_valid = false;
+      dag_changed();
+      _relabels++;
+      if(_dead_entries > _compact_ratio * (2*edges.size() + _dead_entries) ||
+          _dead_vertices > _compact_ratio * vertices.size())
+        compact();
+    }
+
+    // removes the tombstones from the per-vertex lists
+    void drop_tombstones() {
+      auto purge = [](vector<edge> &list) {
+        size_t len = list.size();
+        list.erase(std::remove_if(list.begin(), list.end(),
+              [](const edge &e) { return e.vertex_id == -1; }), list.end());
+        if(list.size() < len)
+          list.shrink_to_fit();
+      };
+
+      if(_dead_entries == 0)
+        return;
+      for(vertex &vtx : vertices) {
+        purge(vtx.outgoing);
+        purge(vtx.incoming);
+      }
+      _dead_entries = 0;
+    }
+
+  public:
+
+    /*
+     * func: add_edge(string &)
+     * desc: takes an edge specification as a single string, 
+     *   parses the string into src vertex, dest vertex and
+     *   weight (optional).
+     *
+     *   If parsing is successful, add_edge(string, string, double) above
+     *   is called to do the "real work".
+     *
+     * returns true on success; false on failure (parse error or
+     *   call to add_edge failed).
+     *
+     * expected format:
+     *
+     *   the given string must have either two or three tokens (exactly).
+     *
+     *   If it has three tokens, the third token must be parseable as
+     *   a double.
+     */
+    bool add_edge(const string &str) {
+      std::stringstream ss(str);
+      string src, dest, junk, weight_str;
+      double weight;
+
+      if(!(ss >> src))
+        return false;
+      if(!(ss >> dest))
+        return false;
+      if(!(ss >> weight_str)){
+        // only two tokens: use default weight
+        weight = 1.0;
+      }
+      else {
+        if(!(std::stringstream(weight_str) >> weight)){
+          // couldn't parse weight
+          return false;
+        }
+
+        if(ss >> junk){
+          // extra token?  format error
+          return false;
+        }
+      }
+
+      add_edge(src, dest, weight);
+
+      return true;
+    }
+
+    void _add_edge(const string &str) {
+
+      if(!add_edge(str))
+        std::cout << "add_edge failed; str='" <<
+          str << "'\n";
+    }
+
+    void display(){
+      int u, v, i;
+      uint64_t pos, k = 0;
+
+      // (a compressed graph is printed from the compressed lists, where
+      //   the k-th edge overall has the k-th weight; removed vertices
+      //   have no edges)
+      if(!_compressed)
+        snapshot();
+      for(u=0; u<vertices.size(); u++) {
+        if(is_removed(u))
+          continue;
+        std::cout << id2name(u) << " : ";
+
+        if(_compressed) {
+          for(pos=_packed.off[u], v=u; pos<_packed.off[u+1]; k++) {
+            v = _packed.next(u, pos, v);
+            edge e(v, _packed.weight(k));
+            p_edge(e);
+          }
+        }
+        else {
+          for(i=_csr.out_off[u]; i<_csr.out_off[u+1]; i++) {
+            edge e(_csr.out_tgt[i], _csr.out_wt[i]);
+            p_edge(e);
+          }
+        }
+        std::cout << "\n";
+      }
+    }
+
+    /*
+     * func: ids2names
+     * desc: utility function which takes a vector of vertex IDs
+     *   and populates another vector of strings with the corresponding
+     *   vertex names.
+     */
+    void ids2names(std::vector<int> &  ids, std::vector<string> & names) {
+      names.clear();
+
+      for(int &u : ids) {
+        names.push_back(id2name(u));
+      }
+    }
+
+    /* 
+     * func: read_file
+     * desc: reades given file (if possible) as a 
+     *   sequence of edges -- one edge per line.
+     *
+     *   Each line is expected to be in the form:
+   
+           <source-vertex> <dest-vertex> {<weight>}
+     *
+     * where the vertices are given as strings and
+     *   the edge weight is a number (read as a double).
+     * The edge weight is optional (indicated by {}).
+     *
+     * Examples:
+         an edge from Chicago to NewYork with weight 201.9:
+
+            Chicago NewYork 201.9
+ 
+         an edge from Bob to Alice with no weight:
+
+             Bob Alice
+
+     * if no weight is specified, the edge defaults to a weight
+     *   of 1.0
+     *
+     * A file written by write_binary is recognized by its first
+     *   bytes and loaded with read_binary instead.
+     *
+     * Implementation:  the file is memory-mapped and split into
+     *   nthreads pieces on line boundaries (nthreads==0 means one per
+     *   hardware thread; small files always use one).  The pieces are
+     *   tokenized in parallel (see edge_list_chunk) and then merged in
+     *   file order, so vertex IDs and adjacency lists come out exactly
+     *   as if the file had been read one line at a time with
+     *   add_edge(string).  (Warnings about ill-formatted lines come
+     *   first, then those about duplicate edges.)  The edges are added
+     *   in one go, as by add_edges, leaving the graph frozen.
+     *
+     *   If the file cannot be mapped (e.g., it is a pipe), it is
+     *   read with read_stream instead.
+     */
+    bool read_file(const string &fname, int nthreads=0) {
+      struct stat st;
+      int fd, k;
+      size_t size;
+      const char *buf;
+
+      fd = open(fname.c_str(), O_RDONLY);
+      if(fd < 0)
+        return false;
+      if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return read_stream(fname);
+      }
+      size = st.st_size;
+      if(size == 0) {
+        close(fd);
+        return true;
+      }
+      buf = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if(buf == MAP_FAILED)
+        return read_stream(fname);
+      if(size >= sizeof(GRAPH_FILE_MAGIC)-1 &&
+          memcmp(buf, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC)-1) == 0) {
+        munmap((void *)buf, size);
+        return read_binary(fname);
+      }
+      madvise((void *)buf, size, MADV_SEQUENTIAL);
+
+      if(nthreads <= 0)
+        nthreads = std::thread::hardware_concurrency();
+      if(nthreads <= 0 || size < (1<<20))
+        nthreads = 1;
+
+      // chunk k is [bounds[k], bounds[k+1]); every boundary is just
+      //   past a newline
+      vector<size_t> bounds(nthreads+1, size);
+      bounds[0] = 0;
+      for(k=1; k<nthreads; k++) {
+        size_t pos = std::max(bounds[k-1], size/nthreads*k);
+        while(pos < size && buf[pos-1] != '\n')
+          pos++;
+        bounds[k] = pos;
+      }
+
+      vector<edge_list_chunk> chunks(nthreads);
+      vector<std::thread> workers;
+      for(k=1; k<nthreads; k++)
+        workers.push_back(std::thread(&edge_list_chunk::parse, &chunks[k],
+              buf+bounds[k], buf+bounds[k+1]));
+      chunks[0].parse(buf, buf+bounds[1]);
+      for(std::thread &t : workers)
+        t.join();
+
+      // names to IDs, in file order; then all of the edges are added
+      //   in one go
+      vector<int> src, dest;
+      vector<double> wt;
+      if(_compressed)
+        uncompress();
+      for(edge_list_chunk &c : chunks) {
+        vector<int> ids(c.names.size());
+
+        for(k=0; k<(int)c.names.size(); k++)
+          ids[k] = vertex_id(c.names[k].p, c.names[k].len);
+        for(edge_list_chunk::line_rec &r : c.lines) {
+          if(r.src == -1) {
+            std::cerr << "warning: skipped input line '"
+              << string(c.bad[r.dest].p, c.bad[r.dest].len)
+              << "' (ill-formatted)\n";
+          }
+          else {
+            src.push_back(ids[r.src]);
+            dest.push_back(ids[r.dest]);
+            wt.push_back(r.weight);
+          }
+        }
+      }
+      munmap((void *)buf, size);
+      insert_edges(src, dest, wt, nthreads);
+      return true;
+    }
+
+    /*
+     * func: read_stream
+     * desc: same as read_file, but reads the file one line at a time
+     *   with getline and add_edge(string).  Works on anything that
+     *   can be opened as an ifstream.
+     */
+    bool read_stream(const string &fname) {
+      std::ifstream file;
+      string line;
+
+      file.open(fname, std::ios::in);
+      if(!file.is_open())
+        return false;
+      
+      while(getline(file, line)) {
+        // skip blank lines
+        if(line.length() > 0) {
+          if(!add_edge(line)) {
+            std::cerr << "warning: skipped input line '" 
+              << line << "' (ill-formatted)\n";
+          }
+        }
+      }
+      file.close();
+      return true;
+    }
+
+
+    /*
+     * func: write_binary
+     * desc: writes the graph to file fname in the binary graph format
+     *   (see graph_file_header).  Such a file can be loaded by
+     *   read_binary -- or by read_file, which recognizes it -- much
+     *   faster than the text format can be parsed.
+     *
+     *   Removed vertices are compacted away first (see compact):  the
+     *   file has no place for them.
+     *
+     * returns true on success; false if the file could not be written.
+     */
+    bool write_binary(const string &fname) {
+      if(_dead_vertices > 0)
+        compact();
+      const csr &c = snapshot();
+      std::ofstream file;
+      graph_file_header h;
+      uint64_t pos;
+      int n = num_nodes();
+
+      file.open(fname, std::ios::out | std::ios::binary | std::ios::trunc);
+      if(!file.is_open())
+        return false;
+
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, GRAPH_FILE_MAGIC, sizeof(h.magic));
+      h.version = GRAPH_FILE_VERSION;
+      h.byte_order = GRAPH_FILE_BYTE_ORDER;
+      h.n = n;
+      h.m = c.out_off[n];
+
+      // header is written twice:  once as a placeholder and again
+      //   at the end, once the section offsets are known
+      file.write((const char *)&h, sizeof(h));
+      pos = sizeof(h);
+      // the name sections are just the name arena
+      h.sec[0] = write_section(file, pos, _names.offsets(),
+          (h.n+1)*sizeof(uint64_t));
+      h.sec[1] = write_section(file, pos, _names.char_data(),
+          _names.offsets()[n]);
+      h.sec[2] = write_section(file, pos, c.out_off.data(), (h.n+1)*sizeof(int));
+      h.sec[3] = write_section(file, pos, c.out_tgt.data(), h.m*sizeof(int));
+      h.sec[4] = write_section(file, pos, c.out_wt.data(), h.m*sizeof(double));
+      h.sec[5] = write_section(file, pos, c.in_off.data(), (h.n+1)*sizeof(int));
+      h.sec[6] = write_section(file, pos, c.in_tgt.data(), h.m*sizeof(int));
+      h.sec[7] = write_section(file, pos, c.in_wt.data(), h.m*sizeof(double));
+
+      file.seekp(0);
+      file.write((const char *)&h, sizeof(h));
+      file.close();
+      return !file.fail();
+    }
+
+    /*
+     * func: read_binary
+     * desc: loads a graph file written by write_binary.
+     *
+     *   If the graph (calling object) is empty, the file is memory
+     *   mapped and the graph is left frozen (see freeze) with its
+     *   CSR snapshot pointing directly into the mapping:  nothing is
+     *   copied but the vertex names.  The only per-edge work is one
+     *   pass checking that the offsets and vertex IDs are in range, so
+     *   that a corrupt file is rejected here instead of crashing some
+     *   algorithm later.
+     *
+     *   If the graph already has vertices, the edges in the file are
+     *   added to it one at a time, as read_file would.
+     *
+     * returns true on success; false if the file could not be opened
+     *   or is not a valid graph file.
+     */
+    bool read_binary(const string &fname) {
+      std::shared_ptr<mapped_file> mf(new mapped_file);
+      const graph_file_header *h;
+      const uint64_t *name_off;
+      const char *names;
+      uint64_t sz[8];
+      int k, u, n, i;
+      bool ok;
+
+      if(!mf->map(fname))
+        return false;
+
+      h = (const graph_file_header *)mf->base;
+      if(mf->size < sizeof(*h) ||
+          memcmp(h->magic, GRAPH_FILE_MAGIC, sizeof(h->magic)) != 0 ||
+          h->version != GRAPH_FILE_VERSION ||
+          h->byte_order != GRAPH_FILE_BYTE_ORDER ||
+          h->n >= (uint64_t)INT32_MAX || h->m >= (uint64_t)INT32_MAX) {
+        std::cerr << "error: '" << fname << "' is not a graph file "
+          << "this program can read\n";
+        return false;
+      }
+      h->section_sizes(sz);
+      for(k=0; k<8; k++) {
+        if(k == 1 && h->sec[0] + sz[0] <= mf->size)
+          sz[1] = ((const uint64_t *)(mf->base + h->sec[0]))[h->n];
+        if(h->sec[k] % 8 != 0 || h->sec[k] > mf->size ||
+            sz[k] > mf->size - h->sec[k]) {
+          std::cerr << "error: graph file '" << fname << "' is truncated\n";
+          return false;
+        }
+      }
+
+      n = h->n;
+      name_off = (const uint64_t *)(mf->base + h->sec[0]);
+      names = mf->base + h->sec[1];
+
+      // (name_off[n] is the size of the names section, checked above)
+      ok = name_off[0] == 0;
+      for(u=0; u<n && ok; u++)
+        ok = name_off[u+1] >= name_off[u];
+      if(!ok || !valid_csr((const int *)(mf->base + h->sec[2]),
+            (const int *)(mf->base + h->sec[3]), h->n, h->m) ||
+          !valid_csr((const int *)(mf->base + h->sec[5]),
+            (const int *)(mf->base + h->sec[6]), h->n, h->m)) {
+        std::cerr << "error: '" << fname << "' is not a graph file "
+          << "this program can read\n";
+        return false;
+      }
+
+      if(num_nodes() > 0) {
+        const int *off = (const int *)(mf->base + h->sec[2]);
+        const int *tgt = (const int *)(mf->base + h->sec[3]);
+        const double *wt = (const double *)(mf->base + h->sec[4]);
+        vector<int> ids(n);
+
+        if(_frozen)
+          thaw();
+        for(u=0; u<n; u++)
+          ids[u] = vertex_id(names+name_off[u], name_off[u+1]-name_off[u]);
+        for(u=0; u<n; u++) {
+          for(i=off[u]; i<off[u+1]; i++)
+            insert_edge(ids[u], ids[tgt[i]], wt[i]);
+        }
+        return true;
+      }
+
+      _names.assign(names, name_off, n);
+      vertices.reserve(n);
+      for(u=0; u<n; u++)
+        vertices.push_back(vertex(u));
+
+      _csr.out_off.view((const int *)(mf->base + h->sec[2]), h->n+1);
+      _csr.out_tgt.view((const int *)(mf->base + h->sec[3]), h->m);
+      _csr.out_wt.view((const double *)(mf->base + h->sec[4]), h->m);
+      _csr.in_off.view((const int *)(mf->base + h->sec[5]), h->n+1);
+      _csr.in_tgt.view((const int *)(mf->base + h->sec[6]), h->m);
+      _csr.in_wt.view((const double *)(mf->base + h->sec[7]), h->m);
+      _csr_valid = true;
+      _frozen = true;
+      _packed = packed_adj();
+      _compressed = false;
+      _mapping = mf;
+      dag_changed();
+      edges.clear();
+      return true;
+    }
+
+
+    int num_nodes() {
+      return vertices.size();
+    }
+    int num_edges() {
+      if(_compressed)
+        return _packed.m;
+      if(_frozen)
+        return _csr.out_tgt.size();
+      return edges.size();
+    }
+
+    int out_degree(int u) {
+      uint64_t pos;
+      int d = 0;
+
+      if(_compressed) {
+        // one neighbor per byte without the high bit
+        for(pos=_packed.off[u]; pos<_packed.off[u+1]; pos++)
+          d += _packed.bytes[pos] < 0x80;
+        return d;
+      }
+      const csr &c = snapshot();
+      return c.out_off[u+1] - c.out_off[u];
+    }
+    int in_degree(int u) {
+      int v, n = num_nodes();
+
+      // a compressed graph has no incoming lists:  the in-degrees are
+      //   counted from the outgoing ones, once
+      if(_compressed) {
+        if(_packed.indeg.empty()) {
+          _packed.indeg.assign(n, 0);
+          for(v=0; v<n; v++)
+            for_each_out(v, [&](int w) { _packed.indeg[w]++; });
+        }
+        return _packed.indeg[u];
+      }
+      const csr &c = snapshot();
+      return c.in_off[u+1] - c.in_off[u];
+    }
+
+    /*
+     * func: freeze
+     * desc: turns the graph into an immutable CSR snapshot for
+     *   read-only workloads:  the snapshot is built (if necessary)
+     *   and the per-vertex outgoing/incoming vectors are released so
+     *   that the adjacency information is stored only once, in flat
+     *   arrays.
+     *
+     *   Every algorithm in this class runs against the snapshot
+     *   whether or not the graph is frozen; freezing just saves the
+     *   memory of the build-time representation.
+     *
+     *   A later add_edge transparently "thaws" the graph (rebuilds the
+     *   per-vertex vectors from the snapshot) before changing it.
+     */
+    void freeze() {
+      if(_frozen)
+        return;
+      snapshot();
+      for(vertex &vtx : vertices) {
+        vector<edge>().swap(vtx.outgoing);
+        vector<edge>().swap(vtx.incoming);
+      }
+      _dead_entries = 0;     // the tombstones went with the lists
+      _frozen = true;
+    }
+
+    bool is_frozen() {
+      return _frozen;
+    }
+
+    /*
+     * func: compress
+     * desc: freezes the graph (see freeze) and then replaces the CSR
+     *   snapshot with a compressed copy of just the outgoing lists
+     *   (see packed_adj):  neighbor IDs are delta + varint coded, and
+     *   weights are
+     *
+     *     dropped if they are all the same (e.g. an unweighted graph)
+     *       or if keep_weights is false (every weight becomes 1);
+     *     stored exactly, as 1 or 2 byte codes into a table, if there
+     *       are at most 65536 distinct weights;
+     *     otherwise rounded to floats.
+     *
+     *   The duplicate-edge index is released too.  A sparse graph
+     *   with small integer weights takes 7-8 bytes per edge instead of
+     *   the 45 or so of a frozen one (see bytes_per_edge); the
+     *   neighbor IDs take fewer bytes after a reorder.
+     *
+     *   bfs, dfs, topo_sort, has_cycle, out_degree, in_degree and
+     *   display decode the lists on the fly and visit the neighbors of
+     *   each vertex in increasing ID order.  Anything else (and
+     *   add_edge) first uncompresses the graph back into the frozen
+     *   snapshot, as add_edge thaws a frozen graph; an algorithm that
+     *   does so prints a warning the first time (see snapshot).
+     *
+     *   The snapshot is built before it is compressed, so the graph
+     *   needs about twice its frozen size while compress runs.
+     */
+    void compress(bool keep_weights=true) {
+      std::unordered_map<double, int> codes;
+      vector<std::pair<int, double> > list;
+      packed_adj p;
+      int u, j, code, n = num_nodes();
+      int64_t d;
+      uint64_t i;
+      float f;
+
+      if(_compressed)
+        return;
+      freeze();
+      p.m = _csr.out_tgt.size();
+
+      if(keep_weights) {
+        for(i=0; i<p.m && codes.size() <= 65536; i++)
+          codes.emplace(_csr.out_wt[i], (int)codes.size());
+      }
+      if(codes.empty())
+        codes.emplace(1.0, 0);
+      p.wbytes = codes.size() == 1 ? 0 : codes.size() <= 256 ? 1 :
+        codes.size() <= 65536 ? 2 : 4;
+      if(p.wbytes < 4) {
+        p.wtab.resize(codes.size());
+        for(auto &c : codes)
+          p.wtab[c.second] = c.first;
+      }
+
+      p.off.resize(n+1);
+      p.bytes.reserve(2*p.m);
+      p.wdata.reserve(p.wbytes*p.m);
+      for(u=0; u<n; u++) {
+        p.off[u] = p.bytes.size();
+        list.clear();
+        for(j=_csr.out_off[u]; j<_csr.out_off[u+1]; j++)
+          list.push_back(std::make_pair(_csr.out_tgt[j], _csr.out_wt[j]));
+        std::sort(list.begin(), list.end());
+
+        for(j=0; j<(int)list.size(); j++) {
+          if(j == 0) {
+            d = (int64_t)list[j].first - u;
+            packed_adj::put(p.bytes, ((uint64_t)d << 1) ^ (uint64_t)(d >> 63));
+          }
+          else
+            packed_adj::put(p.bytes, list[j].first - list[j-1].first);
+
+          if(p.wbytes == 1 || p.wbytes == 2) {
+            code = codes[list[j].second];
+            p.wdata.push_back(code & 0xff);
+            if(p.wbytes == 2)
+              p.wdata.push_back(code >> 8);
+          }
+          else if(p.wbytes == 4) {
+            f = list[j].second;
+            p.wdata.insert(p.wdata.end(), (unsigned char *)&f,
+                (unsigned char *)&f + sizeof(f));
+          }
+        }
+      }
+      p.off[n] = p.bytes.size();
+      p.bytes.shrink_to_fit();
+      p.wdata.shrink_to_fit();
+
+      _packed = std::move(p);
+      _compressed = true;
+      _csr = csr();
+      _csr_valid = false;
+      _mapping.reset();
+      edges.clear();
+    }
+
+    bool is_compressed() {
+      return _compressed;
+    }
+
+    /*
+     * func: adjacency_bytes
+     * desc: memory used to store the edges:  the per-vertex lists, the
+     *   CSR snapshot and the duplicate-edge index, or just the
+     *   compressed lists.  Vertex names are not counted.
+     */
+    size_t adjacency_bytes() {
+      size_t b = edges.bytes();
+
+      if(_compressed)
+        return b + _packed.bytes_used();
+      for(vertex &vtx : vertices)
+        b += (vtx.outgoing.capacity() + vtx.incoming.capacity())*sizeof(edge);
+      if(_csr_valid) {
+        b += (_csr.out_off.size() + _csr.out_tgt.size() +
+            _csr.in_off.size() + _csr.in_tgt.size())*sizeof(int) +
+          (_csr.out_wt.size() + _csr.in_wt.size())*sizeof(double);
+      }
+      return b;
+    }
+
+    double bytes_per_edge() {
+      return num_edges() == 0 ? 0 : (double)adjacency_bytes() / num_edges();
+    }
+
+    /*
+     * func:  compact
+     * desc:  cleans up after removals (see remove_edge and
+     *   remove_vertex):  drops the tombstones from the adjacency lists
+     *   and, if vertices were removed, numbers the remaining ones
+     *   0..V-1 again, keeping their relative order.  Vertex u becomes
+     *   new_id[u] (-1 for a removed vertex); names, the edge index
+     *   and orig_id follow the vertices as in reorder, and the
+     *   function given to on_compact (if any) is called with new_id.
+     *   A frozen graph stays frozen, and a compressed one compressed.
+     *
+     *   Removals call it by themselves once compact_ratio is passed;
+     *   call it directly to release the memory sooner or to be rid of
+     *   removed vertices before, e.g., scc.
+     *
+     *   A dynamic_topo of the graph notices that the vertices were
+     *   renumbered and builds its order again; alt_index, ch_index and
+     *   reach_index notice too (as after any removal).
+     *
+     * RUNTIME:  O(V+E)
+     */
+    void compact(vector<int> &new_id) {
+      int u, k = 0, n = num_nodes();
+      bool was_frozen = _frozen, was_compressed = _compressed;
+
+      new_id.resize(n);
+      for(u=0; u<n; u++)
+        new_id[u] = vertices[u].id == -1 ? -1 : k++;
+      drop_tombstones();      // (a frozen graph has none)
+      if(k == n)
+        return;
+
+      if(_frozen)
+        thaw();
+      if(_orig_id.empty()) {
+        _orig_id.resize(n);
+        for(u=0; u<n; u++)
+          _orig_id[u] = u;
+        _orig_n = n;
+      }
+      // new_id[u] <= u, so the vertices can move down in place
+      for(u=0; u<n; u++) {
+        if(new_id[u] == -1)
+          continue;
+        vertex &vtx = vertices[new_id[u]];
+        if(new_id[u] != u)
+          vtx = std::move(vertices[u]);
+        vtx.id = new_id[u];
+        for(edge &e : vtx.outgoing)
+          e.vertex_id = new_id[e.vertex_id];
+        for(edge &e : vtx.incoming)
+          e.vertex_id = new_id[e.vertex_id];
+        _orig_id[new_id[u]] = _orig_id[u];
+      }
+      vertices.resize(k);
+      _orig_id.resize(k);
+      _names.permute(new_id);
+      _dead_vertices = 0;
+
+      edges.clear();
+      edges.reserve(num_edges_in_lists());
+      for(u=0; u<k; u++) {
+        for(edge &e : vertices[u].outgoing)
+          edges.insert(u, e.vertex_id);
+      }
+
+      _csr_valid = false;
+      dag_changed();
+      _relabels++;
+      if(was_compressed)
+        compress();
+      else if(was_frozen)
+        freeze();
+      if(_on_compact)
+        _on_compact(new_id);
+    }
+
+    void compact() {
+      vector<int> new_id;
+      compact(new_id);
+    }
+
+    /*
+     * func:  compact_ratio
+     * desc:  sets when removals compact the graph:  once tombstones
+     *   are more than ratio of all adjacency list entries, or removed
+     *   vertices more than ratio of all vertices (default 0.25).  A
+     *   compaction is O(V+E), paid for by the ratio*E (or ratio*V)
+     *   removals before it.  A ratio of 1 or more turns automatic
+     *   compaction off.
+     */
+    void compact_ratio(double ratio) {
+      _compact_ratio = ratio;
+    }
+
+    /*
+     * func:  on_compact
+     * desc:  fn(new_id) will be called after every compaction that
+     *   renumbers vertices (vertex u is now new_id[u], or is gone if
+     *   new_id[u] is -1), so that whoever holds on to vertex IDs can
+     *   translate them.
+     */
+    void on_compact(const std::function<void(const vector<int> &)> &fn) {
+      _on_compact = fn;
+    }
+
+    // true if vertex u was removed (and the graph not compacted since)
+    bool is_removed(int u) {
+      return vertices[u].id == -1;
+    }
+
+    /*
+     * func:  reorder
+     * desc:  renumbers the vertices:  vertex u becomes vertex
+     *   new_id[u].  Names, edges and weights are unchanged; the
+     *   vertices vector, _names, the adjacency lists (which are also
+     *   sorted by neighbor ID) and the edge index are all rebuilt with
+     *   the new IDs, as is the CSR snapshot.  A frozen graph stays
+     *   frozen, and a compressed one compressed.
+     *
+     *   Traversals are faster when vertices that are visited together
+     *   have nearby IDs; degree_order, bfs_order and rcm_order compute
+     *   such numberings.
+     *
+     *   orig_id and to_original translate IDs and reports back to the
+     *   IDs the vertices had before the first reorder.
+     *
+     *   A dynamic_topo of the graph builds its order again afterwards;
+     *   alt_index, ch_index and reach_index notice and refuse to
+     *   answer (or rebuild).
+     *
+     * returns false (leaving the graph unchanged) if new_id is not a
+     *   permutation of 0..V-1.
+     *
+     * RUNTIME:  O(V + E log d), d the largest degree
+     */
+    bool reorder(const vector<int> &new_id) {
+      int u, n = num_nodes();
+      vector<char> used(n, 0);
+      vector<vertex> old;
+      vector<int> orig(n);
+      bool was_frozen = _frozen, was_compressed = _compressed;
+      auto by_id = [](const edge &a, const edge &b) {
+        return a.vertex_id < b.vertex_id;
+      };
+
+      if((int)new_id.size() != n)
+        return false;
+      for(u=0; u<n; u++) {
+        if(new_id[u] < 0 || new_id[u] >= n || used[new_id[u]])
+          return false;
+        used[new_id[u]] = 1;
+      }
+
+      if(_frozen)
+        thaw();
+      drop_tombstones();
+      old.swap(vertices);
+      vertices.resize(n);
+      for(u=0; u<n; u++) {
+        vertex &vtx = vertices[new_id[u]];
+        vtx = std::move(old[u]);
+        if(vtx.id != -1)        // removed vertices stay removed
+          vtx.id = new_id[u];
+        for(edge &e : vtx.outgoing)
+          e.vertex_id = new_id[e.vertex_id];
+        for(edge &e : vtx.incoming)
+          e.vertex_id = new_id[e.vertex_id];
+        std::sort(vtx.outgoing.begin(), vtx.outgoing.end(), by_id);
+        std::sort(vtx.incoming.begin(), vtx.incoming.end(), by_id);
+        orig[new_id[u]] = _orig_id.empty() ? u : _orig_id[u];
+      }
+      if(_orig_id.empty())
+        _orig_n = n;
+      _orig_id.swap(orig);
+      _names.permute(new_id);
+
+      edges.clear();
+      edges.reserve(num_edges_in_lists());
+      for(u=0; u<n; u++) {
+        for(edge &e : vertices[u].outgoing)
+          edges.insert(u, e.vertex_id);
+      }
+
+      _csr_valid = false;
+      dag_changed();
+      _relabels++;
+      if(was_compressed)
+        compress();
+      else if(was_frozen)
+        freeze();
+      return true;
+    }
+
+    // ID vertex u had before the graph was first reordered
+    int orig_id(int u) const {
+      return _orig_id.empty() ? u : _orig_id[u];
+    }
+
+    /*
+     * func:  to_original
+     * desc:  translates a report (e.g. from bfs) made after the graph
+     *   was reordered or compacted into one indexed by the original
+     *   vertex IDs, with the preds translated too.  Vertices removed
+     *   by a compaction get UNDISCOVERED entries.
+     */
+    void to_original(const vector<vertex_label> &rpt,
+        vector<vertex_label> &orig_rpt) const {
+      size_t u;
+
+      orig_rpt.assign(_orig_id.empty() ? rpt.size() : _orig_n,
+          vertex_label(-1, -1, UNDISCOVERED));
+      for(u=0; u<rpt.size(); u++) {
+        vertex_label &lab = orig_rpt[orig_id(u)];
+        lab = rpt[u];
+        if(lab.pred != -1)
+          lab.pred = orig_id(lab.pred);
+      }
+    }
+
+    /*
+     * func:  degree_order
+     * desc:  numbering for reorder that puts the vertices in order of
+     *   decreasing degree (in + out; ties by ID), so the hubs most
+     *   traversals keep coming back to share a few cache lines.
+     *
+     * RUNTIME:  O(V)  (counting sort)
+     */
+    void degree_order(vector<int> &new_id) {
+      const csr &c = snapshot();
+      vector<int> cnt;
+      int u, d, n = num_nodes(), maxd = 0;
+
+      new_id.resize(n);
+      for(u=0; u<n; u++)
+        maxd = std::max(maxd, total_degree(c, u));
+      cnt.assign(maxd+2, 0);
+      for(u=0; u<n; u++)
+        cnt[maxd - total_degree(c, u) + 1]++;
+      for(d=0; d<=maxd; d++)
+        cnt[d+1] += cnt[d];
+      for(u=0; u<n; u++)
+        new_id[u] = cnt[maxd - total_degree(c, u)]++;
+    }
+
+    /*
+     * func:  bfs_order
+     * desc:  numbering for reorder in the order a breadth-first search
+     *   (ignoring edge directions) discovers the vertices, starting
+     *   from the lowest unnumbered ID for each connected piece.
+     *   Neighbors get nearby IDs, which is what bfs and dfs touch next.
+     *
+     * RUNTIME:  O(V+E)
+     */
+    void bfs_order(vector<int> &new_id) {
+      cm_order(new_id, false);
+    }
+
+    /*
+     * func:  rcm_order
+     * desc:  numbering for reorder by reverse Cuthill-McKee:  like
+     *   bfs_order, but each piece starts from a far-out low-degree
+     *   vertex and neighbors are numbered in order of increasing
+     *   degree; then the order is reversed.  Keeps the IDs of the two
+     *   ends of each edge close together (low "bandwidth").
+     *
+     * RUNTIME:  O(V + E log d), d the largest degree
+     */
+    void rcm_order(vector<int> &new_id) {
+      int u, n = num_nodes();
+
+      cm_order(new_id, true);
+      for(u=0; u<n; u++)
+        new_id[u] = n - 1 - new_id[u];
+    }
+
+  private:
+    static int total_degree(const csr &c, int u) {
+      return c.out_off[u+1] - c.out_off[u] + c.in_off[u+1] - c.in_off[u];
+    }
+
+    // edges in the per-vertex lists (the graph must not be frozen)
+    size_t num_edges_in_lists() const {
+      size_t m = 0;
+
+      for(const vertex &vtx : vertices)
+        m += vtx.outgoing.size();
+      return m;
+    }
+
+    /*
+     * function:  cm_order
+     * desc:  bfs_order (cuthill_mckee false) or the Cuthill-McKee
+     *   order (true) of the vertices, as new IDs.  For Cuthill-McKee
+     *   each piece is started from a vertex of least degree in the
+     *   last level of a search from its least-degree vertex (a
+     *   "pseudo-peripheral" vertex).
+     */
+    void cm_order(vector<int> &new_id, bool cuthill_mckee) {
+      const csr &c = snapshot();
+      vector<int> order, probe, starts, mark, nbrs;
+      vector<char> placed;
+      int u, v, i, s, n = num_nodes();
+      size_t head, lvl, last;
+      auto by_degree = [&](int a, int b) {
+        int da = total_degree(c, a), db = total_degree(c, b);
+        return da < db || (da == db && a < b);
+      };
+
+      placed.assign(n, 0);
+      order.reserve(n);
+      for(u=0; u<n; u++)
+        starts.push_back(u);
+      if(cuthill_mckee) {
+        degree_order(new_id);
+        for(u=0; u<n; u++)
+          starts[n - 1 - new_id[u]] = u;
+        mark.assign(n, -1);
+      }
+
+      for(int r : starts) {
+        if(placed[r])
+          continue;
+        s = r;
+        if(cuthill_mckee) {
+          // search from r (numbering nothing); mark[] holds r
+          probe.assign(1, r);
+          mark[r] = r;
+          lvl = last = 0;
+          for(head=0; head<probe.size(); head++) {
+            if(head == lvl) {
+              last = lvl;           // start of this level
+              lvl = probe.size();   // start of the next one
+            }
+            u = probe[head];
+            for(i=c.out_off[u]; i<c.out_off[u+1]; i++)
+              visit(c.out_tgt[i], r, mark, probe);
+            for(i=c.in_off[u]; i<c.in_off[u+1]; i++)
+              visit(c.in_tgt[i], r, mark, probe);
+          }
+          // last is now the start of the last level
+          for(head=last; head<probe.size(); head++) {
+            if(by_degree(probe[head], s) || s == r)
+              s = probe[head];
+          }
+        }
+
+        head = order.size();
+        order.push_back(s);
+        placed[s] = 1;
+        for(; head<order.size(); head++) {
+          u = order[head];
+          nbrs.clear();
+          for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+            v = c.out_tgt[i];
+            if(!placed[v]) {
+              placed[v] = 1;
+              nbrs.push_back(v);
+            }
+          }
+          for(i=c.in_off[u]; i<c.in_off[u+1]; i++) {
+            v = c.in_tgt[i];
+            if(!placed[v]) {
+              placed[v] = 1;
+              nbrs.push_back(v);
+            }
+          }
+          if(cuthill_mckee)
+            std::sort(nbrs.begin(), nbrs.end(), by_degree);
+          order.insert(order.end(), nbrs.begin(), nbrs.end());
+        }
+      }
+
+      new_id.resize(n);
+      for(i=0; i<n; i++)
+        new_id[order[i]] = i;
+    }
+
+    static void visit(int v, int r, vector<int> &mark, vector<int> &order) {
+      if(mark[v] != r) {
+        mark[v] = r;
+        order.push_back(v);
+      }
+    }
+
+  private:
+    // npaths += more, sticking at LLONG_MAX instead of overflowing
+    //   (exact counts beyond that:  see bfs_num_paths)
+    static void add_npaths(long long &npaths, long long more) {
+      npaths = (npaths > LLONG_MAX - more) ? LLONG_MAX : npaths + more;
+    }
+
+    void init_report(std::vector<vertex_label> & report) {
+      int u;
+
+      report.clear();
+      for(u=0; u<vertices.size(); u++) {
+        report.push_back(vertex_label(-1, -1, UNDISCOVERED));
+      }
+    }
+
+
+  public:
+    /*
+     * TODO 10 points
+     *
+     * modify bfs so that vertex labels reflect the NUMBER OF 
+     *   SHORTEST PATHS TO THE VERTEX LABELED:
+     *
+     *     report[u].npaths is assigned the number of shortest 
+     *        paths from src to u.
+     *
+     *   OBSERVATIONS:
+     *
+     *     report[src].npaths will be 1.
+     *
+     *     if a vertex u is not reachable from src, then 
+     *     report[u].npaths will be assigned 0. 
+     *
+     * RUNTIME:  bfs must still be O(V+E).
+     *
+     */   
+    bool bfs(int src, std::vector<vertex_label> &report) 
+    {
+      int u;
+      std::queue<int> q;
+
+      if(src < 0 || src >= num_nodes())
+        return false;
+
+      ready_adjacency();
+
+      init_report(report);
+
+      report[src].dist = 0;
+
+      // since src is the root of the bfs tree, it has no 
+      //   predecessor.
+      // By convention, we set the predecessor to itself.
+      report[src].pred = src;
+      report[src].npaths++;
+      report[src].state = DISCOVERED;
+      q.push(src);
+
+      while(!q.empty()) {
+        // dequeue front node from queue
+        u = q.front();
+        q.pop();
+
+        // examine outgoing edges of u
+        for_each_out(u, [&](int v) {
+          if(report[v].state == UNDISCOVERED) {
+              
+            add_npaths(report[v].npaths, report[u].npaths);
+            report[v].dist = report[u].dist + 1;
+            report[v].pred = u;
+            report[v].state = DISCOVERED;
+          
+            // enqueue newly discovered vertex
+            q.push(v);
+          }
+          else
+          {
+              if (report[v].dist == report[u].dist+1 )
+              {
+                 
+                  add_npaths(report[v].npaths, report[u].npaths);
+
+              }
+              
+          }
+          
+        });
+      }
+      return true;
+    }
+
+    bool bfs(const string src, std::vector<vertex_label> &report) {
+      int u;
+
+      if((u=name2id(src)) == -1)
+          return false;
+      bfs(u, report);
+      return true;
+    }
+
+    /*
+     * func:  bfs_num_paths
+     * desc:  counts shortest paths like bfs does (report[u].npaths),
+     *   but in counter type C -- see dag_num_paths(vector<C> &) for the
+     *   choices -- for graphs where the counts outgrow npaths:
+     *
+     *      npaths[u] = number of shortest paths from src to u
+     *                  (C(0) if u is not reachable)
+     *
+     *   If dist is not NULL, the distances (-1: unreachable) are
+     *   stored there as well.
+     *
+     * RUNTIME:  O(V+E) counter operations.
+     */
+    template <typename C>
+    bool bfs_num_paths(int src, vector<C> &npaths, vector<int> *dist=NULL) {
+      int u, v, i, qhead;
+      vector<int> d, q;
+
+      if(src < 0 || src >= num_nodes())
+        return false;
+
+      const csr &c = snapshot();
+      npaths.assign(num_nodes(), C(0));
+      d.assign(num_nodes(), -1);
+      d[src] = 0;
+      npaths[src] = C(1);
+      q.push_back(src);
+      for(qhead=0; qhead<q.size(); qhead++) {
+        u = q[qhead];
+        for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+          v = c.out_tgt[i];
+          if(d[v] == -1) {
+            d[v] = d[u] + 1;
+            q.push_back(v);
+          }
+          if(d[v] == d[u] + 1)
+            npaths[v] += npaths[u];
+        }
+      }
+      if(dist != NULL)
+        dist->swap(d);
+      return true;
+    }
+
+    /*
+     * func:  bfs_dir_opt
+     * desc:  direction-optimizing ("top-down/bottom-up") version of bfs.
+     *   Produces the same dist and npaths labels as bfs (pred may name
+     *   a different, equally short, predecessor).
+     *
+     *   Each level of the search is expanded in one of two ways:
+     *
+     *     top-down:  like bfs -- scan the outgoing edges of every
+     *       vertex in the frontier (the vertices at distance d).
+     *
+     *     bottom-up:  scan the incoming edges of every vertex not yet
+     *       discovered, looking for in-neighbors in the frontier
+     *       (which is kept as a bitmap for this).  A vertex that has
+     *       such an in-neighbor is at distance d+1, and its npaths is
+     *       the sum of npaths over ALL of its frontier in-neighbors.
+     *
+     *   When the frontier is large, most of the edges a top-down step
+     *   looks at lead to vertices that are already discovered; a
+     *   bottom-up step never looks at those edges at all.  The choice
+     *   is made at every level (heuristic of Beamer et al.):
+     *
+     *     go bottom-up when the frontier's out-edges outnumber
+     *       1/BFS_ALPHA of the undiscovered vertices' in-edges;
+     *     go back top-down when the frontier is shrinking and has
+     *       fewer than 1/BFS_BETA of all vertices.
+     *
+     *   Because npaths needs every frontier in-neighbor, a bottom-up
+     *   step can not stop scanning a vertex at the first one it finds
+     *   (plain direction-optimizing BFS does).
+     *
+     *   If edges_examined is given, the number of edges looked at is
+     *   stored there.
+     *
+     * RUNTIME:  O(V+E) per level in the worst case; in practice a
+     *   small fraction of the edges bfs examines on graphs with a
+     *   small diameter.
+     */
+    bool bfs_dir_opt(int src, std::vector<vertex_label> &report,
+        long long *edges_examined=NULL) {
+      const int BFS_ALPHA = 14;
+      const int BFS_BETA = 24;
+      int u, v, i, n = num_nodes();
+      long long examined = 0;
+      long long m_f, m_u;          // frontier out-edges / unvisited in-edges
+      bool bottom_up = false;
+      vector<int> frontier, next;
+      vector<uint64_t> in_frontier, visited;
+
+      if(src < 0 || src >= n)
+        return false;
+
+      const csr &c = snapshot();
+      init_report(report);
+      in_frontier.assign((n+63)/64, 0);
+      visited.assign((n+63)/64, 0);
+
+      report[src].dist = 0;
+      report[src].pred = src;
+      report[src].npaths = 1;
+      report[src].state = DISCOVERED;
+      visited[src/64] |= (uint64_t)1 << (src%64);
+      frontier.push_back(src);
+      m_f = c.out_off[src+1] - c.out_off[src];
+      m_u = c.in_off[n] - (c.in_off[src+1] - c.in_off[src]);
+
+      while(!frontier.empty()) {
+        double d = report[frontier[0]].dist + 1;
+
+        if(!bottom_up && m_f > m_u / BFS_ALPHA)
+          bottom_up = true;
+        else if(bottom_up && frontier.size() < next.size() &&
+            (int)frontier.size() < n / BFS_BETA)
+          bottom_up = false;
+
+        next.clear();
+        if(bottom_up) {
+          for(int u : frontier)
+            in_frontier[u/64] |= (uint64_t)1 << (u%64);
+
+          for(v=0; v<n; v++) {
+            if(visited[v/64] >> (v%64) & 1)
+              continue;
+            for(i=c.in_off[v]; i<c.in_off[v+1]; i++) {
+              u = c.in_tgt[i];
+              examined++;
+              if(in_frontier[u/64] >> (u%64) & 1) {
+                if(report[v].state == UNDISCOVERED) {
+                  report[v].dist = d;
+                  report[v].pred = u;
+                  report[v].state = DISCOVERED;
+                  next.push_back(v);
+                }
+                add_npaths(report[v].npaths, report[u].npaths);
+              }
+            }
+          }
+          for(int u : frontier)
+            in_frontier[u/64] = 0;
+        }
+        else {
+          for(int u : frontier) {
+            for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+              v = c.out_tgt[i];
+              examined++;
+              if(report[v].state == UNDISCOVERED) {
+                report[v].dist = d;
+                report[v].pred = u;
+                report[v].state = DISCOVERED;
+                next.push_back(v);
+              }
+              if(report[v].dist == d)
+                add_npaths(report[v].npaths, report[u].npaths);
+            }
+          }
+        }
+
+        m_f = 0;
+        for(int v : next) {
+          visited[v/64] |= (uint64_t)1 << (v%64);
+          m_f += c.out_off[v+1] - c.out_off[v];
+          m_u -= c.in_off[v+1] - c.in_off[v];
+        }
+        // (next keeps the old frontier so the shrinking test above
+        //   can compare sizes)
+        frontier.swap(next);
+      }
+
+      if(edges_examined != NULL)
+        *edges_examined = examined;
+      return true;
+    }
+
+    bool bfs_dir_opt(const string src, std::vector<vertex_label> &report,
+        long long *edges_examined=NULL) {
+      int u;
+
+      if((u=name2id(src)) == -1)
+          return false;
+      return bfs_dir_opt(u, report, edges_examined);
+    }
+
+    /*
+     * func:  bfs_par
+     * desc:  multi-threaded, level-synchronous version of bfs using
+     *   nthreads threads (nthreads <= 0: one per hardware thread).
+     *   The dist and npaths labels are identical to those of bfs; pred
+     *   is the first shortest-path predecessor in the vertex's list of
+     *   incoming edges, so it does not depend on thread timing.
+     *
+     *   Every level is done in two parallel phases:
+     *
+     *     discover:  the frontier (vertices at distance d) is split
+     *       among the threads, which scan outgoing edges.  An
+     *       undiscovered vertex is claimed with an atomic
+     *       compare-and-swap on its level so exactly one thread puts it
+     *       in its own next-frontier buffer; the buffers are then
+     *       concatenated.
+     *
+     *     count:  the new frontier is split among the threads and each
+     *       vertex v pulls npaths from its in-neighbors at distance d.
+     *       Only the thread that owns v writes v's label, and the
+     *       values it reads were finished in the previous level, so
+     *       there are no races and the sums are exact.
+     *
+     * RUNTIME:  O(V+E) work in total; one synchronization per phase
+     *   per level.
+     */
+    bool bfs_par(int src, std::vector<vertex_label> &report, int nthreads=0) {
+      int n = num_nodes();
+      int d;
+
+      if(src < 0 || src >= n)
+        return false;
+
+      const csr &c = snapshot();
+      worker_pool &wp = pool(nthreads);
+      vector<std::atomic<int> > level(n);
+      vector<vector<int> > local(wp.size());
+      vector<int> frontier, next;
+
+      init_report(report);
+      for(std::atomic<int> &l : level)
+        l.store(-1, std::memory_order_relaxed);
+
+      level[src].store(0);
+      report[src].dist = 0;
+      report[src].pred = src;
+      report[src].npaths = 1;
+      report[src].state = DISCOVERED;
+      frontier.push_back(src);
+
+      for(d=0; !frontier.empty(); d++) {
+
+        // discover
+        wp.for_blocks(frontier.size(), [&](size_t lo, size_t hi, int tid) {
+          vector<int> &mine = local[tid];
+          int expected, i, u, v;
+
+          for(size_t k=lo; k<hi; k++) {
+            u = frontier[k];
+            for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+              v = c.out_tgt[i];
+              expected = -1;
+              if(level[v].load(std::memory_order_relaxed) == -1 &&
+                  level[v].compare_exchange_strong(expected, d+1,
+                    std::memory_order_relaxed))
+                mine.push_back(v);
+            }
+          }
+        }, 64);
+
+        next.clear();
+        for(vector<int> &mine : local) {
+          next.insert(next.end(), mine.begin(), mine.end());
+          mine.clear();
+        }
+
+        // count
+        wp.for_blocks(next.size(), [&](size_t lo, size_t hi, int /*tid*/) {
+          int i, u, v;
+
+          for(size_t k=lo; k<hi; k++) {
+            v = next[k];
+            vertex_label &lbl = report[v];
+            lbl.dist = d+1;
+            lbl.state = DISCOVERED;
+            for(i=c.in_off[v]; i<c.in_off[v+1]; i++) {
+              u = c.in_tgt[i];
+              if(level[u].load(std::memory_order_relaxed) == d) {
+                if(lbl.pred == -1)
+                  lbl.pred = u;
+                add_npaths(lbl.npaths, report[u].npaths);
+              }
+            }
+          }
+        }, 256);
+
+        frontier.swap(next);
+      }
+      return true;
+    }
+
+    bool bfs_par(const string src, std::vector<vertex_label> &report,
+        int nthreads=0) {
+      int u;
+
+      if((u=name2id(src)) == -1)
+          return false;
+      return bfs_par(u, report, nthreads);
+    }
+
+    /*
+     * func:  bidir_bfs
+     * desc:  shortest path (fewest edges) from src to dest by
+     *   bidirectional breadth-first search:  a forward search from src
+     *   over outgoing edges and a backward search from dest over
+     *   incoming edges take turns, always expanding the smaller
+     *   frontier by one whole level, until they meet.  When a level
+     *   produces meeting vertices the shortest path goes through the
+     *   best of them.
+     *
+     *   On success path holds the vertex IDs of the path, src first
+     *   and dest last (just src if src == dest).
+     *
+     * returns false (and an empty path) if src or dest is out of
+     *   range or dest is not reachable from src.
+     *
+     * RUNTIME:  proportional to the edges explored by the two
+     *   searches, which is usually far less than a full bfs from src;
+     *   when the searches would each reach r vertices by the time they
+     *   meet, a single search would have to reach about r*r.
+     */
+    bool bidir_bfs(int src, int dest, vector<int> &path) {
+      int n = num_nodes();
+      int s, v, i, meet;
+      double best;
+      vector<int> frontier[2], next;
+
+      path.clear();
+      if(src < 0 || src >= n || dest < 0 || dest >= n)
+        return false;
+
+      const csr &c = snapshot();
+      _bidir.start(n);
+      _bidir.reach(0, src, 0, src);
+      _bidir.reach(1, dest, 0, dest);
+      frontier[0].push_back(src);
+      frontier[1].push_back(dest);
+      meet = (src == dest) ? src : -1;
+
+      while(meet == -1 && !frontier[0].empty() && !frontier[1].empty()) {
+        s = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        const flat_array<int> &off = s == 0 ? c.out_off : c.in_off;
+        const flat_array<int> &tgt = s == 0 ? c.out_tgt : c.in_tgt;
+
+        next.clear();
+        best = -1;
+        for(int u : frontier[s]) {
+          for(i=off[u]; i<off[u+1]; i++) {
+            v = tgt[i];
+            if(_bidir.reached(s, v))
+              continue;
+            _bidir.reach(s, v, _bidir.dist[s][u] + 1, u);
+            next.push_back(v);
+            if(_bidir.reached(1-s, v) &&
+                (best == -1 || _bidir.dist[s][v] + _bidir.dist[1-s][v] < best)) {
+              best = _bidir.dist[s][v] + _bidir.dist[1-s][v];
+              meet = v;
+            }
+          }
+        }
+        frontier[s].swap(next);
+      }
+      if(meet == -1)
+        return false;
+      bidir_path(meet, path);
+      return true;
+    }
+
+    bool bidir_bfs(const string src, const string dest, vector<int> &path) {
+      path.clear();
+      return bidir_bfs(name2id(src), name2id(dest), path);
+    }
+
+    /*
+     * func:  bidir_dijkstra
+     * desc:  shortest (minimum weight) path from src to dest by
+     *   bidirectional Dijkstra:  a forward search from src and a
+     *   backward search from dest (over incoming edges) take turns,
+     *   the one with the smaller queue minimum going next.  mu, the
+     *   best src-dest distance seen where the searches touch, is
+     *   updated as edges are scanned; the search stops once the two
+     *   queue minimums add up to mu or more, since no path left can be
+     *   shorter.
+     *
+     *   On success path holds the path from src to dest (see
+     *   bidir_bfs); if length is not NULL the path's length (sum of
+     *   weights) is stored there, and if settled is not NULL the
+     *   number of vertices settled by both searches together.
+     *
+     * returns false if src or dest is out of range, dest is not
+     *   reachable from src, or the search ran into a negative weight.
+     *
+     * RUNTIME:  O(m log m) for the m edges scanned by the two
+     *   searches.
+     */
+    bool bidir_dijkstra(int src, int dest, vector<int> &path,
+        double *length=NULL, long long *settled=NULL) {
+      typedef std::pair<double, int> entry;
+      typedef std::priority_queue<entry, vector<entry>, std::greater<entry> > min_queue;
+      int n = num_nodes();
+      int s, u, v, i, meet;
+      double du, nd, mu = -1;
+      long long nsettled = 0;
+      min_queue q[2];
+
+      path.clear();
+      if(src < 0 || src >= n || dest < 0 || dest >= n)
+        return false;
+
+      const csr &c = snapshot();
+      _bidir.start(n);
+      _bidir.reach(0, src, 0, src);
+      _bidir.reach(1, dest, 0, dest);
+      q[0].push(entry(0, src));
+      q[1].push(entry(0, dest));
+      meet = (src == dest) ? src : -1;
+      if(meet != -1)
+        mu = 0;
+
+      while(!q[0].empty() && !q[1].empty()) {
+        if(mu != -1 && q[0].top().first + q[1].top().first >= mu)
+          break;
+        s = q[0].top().first <= q[1].top().first ? 0 : 1;
+        du = q[s].top().first;
+        u = q[s].top().second;
+        q[s].pop();
+        // queue entries are not removed when a vertex gets a shorter
+        //   distance; skip the old ones
+        if(_bidir.settled(s, u) || du > _bidir.dist[s][u])
+          continue;
+        _bidir.done[s][u] = _bidir.round;
+        nsettled++;
+
+        const flat_array<int> &off = s == 0 ? c.out_off : c.in_off;
+        const flat_array<int> &tgt = s == 0 ? c.out_tgt : c.in_tgt;
+        const flat_array<double> &wt = s == 0 ? c.out_wt : c.in_wt;
+        for(i=off[u]; i<off[u+1]; i++) {
+          v = tgt[i];
+          if(wt[i] < 0)
+            return false;
+          nd = du + wt[i];
+          if(!_bidir.reached(s, v) || nd < _bidir.dist[s][v]) {
+            _bidir.reach(s, v, nd, u);
+            q[s].push(entry(nd, v));
+          }
+          if(_bidir.reached(1-s, v) &&
+              (mu == -1 || _bidir.dist[s][v] + _bidir.dist[1-s][v] < mu)) {
+            mu = _bidir.dist[s][v] + _bidir.dist[1-s][v];
+            meet = v;
+          }
+        }
+      }
+      if(settled != NULL)
+        *settled = nsettled;
+      if(meet == -1)
+        return false;
+      if(length != NULL)
+        *length = mu;
+      bidir_path(meet, path);
+      return true;
+    }
+
+    bool bidir_dijkstra(const string src, const string dest, vector<int> &path,
+        double *length=NULL, long long *settled=NULL) {
+      path.clear();
+      return bidir_dijkstra(name2id(src), name2id(dest), path, length, settled);
+    }
+
+  private:
+    /*
+     * function:  bidir_path
+     * desc:  after bidir_bfs or bidir_dijkstra:  the src-meet part of
+     *   the path from the forward labels followed by the meet-dest
+     *   part from the backward labels.
+     */
+    void bidir_path(int meet, vector<int> &path) {
+      int u;
+
+      path.clear();
+      for(u=meet; _bidir.pred[0][u] != u; u=_bidir.pred[0][u])
+        path.push_back(u);
+      path.push_back(u);
+      std::reverse(path.begin(), path.end());
+      for(u=meet; _bidir.pred[1][u] != u; ) {
+        u = _bidir.pred[1][u];
+        path.push_back(u);
+      }
+    }
+
+    /*
+     * function:  ms_bfs_batch
+     * desc:  multi-source BFS ("MS-BFS") from k <= 64 sources at once.
+     *
+     *   Every vertex v has three 64-bit masks; bit i belongs to the
+     *   search from src[i]:
+     *
+     *     seen[v]:   searches that have reached v
+     *     visit[v]:  searches for which v is in the current frontier
+     *     next[v]:   searches for which v is in the next frontier
+     *
+     *   Expanding a frontier vertex u sends all of visit[u] across each
+     *   outgoing edge with one OR, so one scan of an edge serves all k
+     *   searches.
+     *
+     *   Results go either to reports rpt[0..k-1] (already initialized
+     *   with init_report; npaths is only filled if count_paths) or, if
+     *   rpt is NULL, to the distance matrix dist:  dist[v*stride + i]
+     *   is the distance from src[i] to v (already initialized to -1).
+     */
+    void ms_bfs_batch(const int *src, int k, vector<vertex_label> **rpt,
+        int *dist, int stride, bool count_paths) {
+      const csr &c = snapshot();
+      int n = num_nodes();
+      int i, j, u, v, d;
+      uint64_t bits, newbits;
+      vector<uint64_t> seen(n, 0), visit(n, 0), next(n, 0);
+      vector<int> frontier, touched;
+
+      for(i=0; i<k; i++) {
+        u = src[i];
+        if(seen[u] == 0)
+          frontier.push_back(u);
+        seen[u] |= (uint64_t)1 << i;
+        visit[u] |= (uint64_t)1 << i;
+        if(rpt != NULL) {
+          (*rpt[i])[u].dist = 0;
+          (*rpt[i])[u].pred = u;
+          (*rpt[i])[u].npaths = 1;
+          (*rpt[i])[u].state = DISCOVERED;
+        }
+        else
+          dist[(size_t)u*stride + i] = 0;
+      }
+
+      for(d=1; !frontier.empty(); d++) {
+        touched.clear();
+        for(int u : frontier) {
+          for(j=c.out_off[u]; j<c.out_off[u+1]; j++) {
+            v = c.out_tgt[j];
+            bits = visit[u] & ~seen[v];
+            if(bits == 0)
+              continue;
+            if(next[v] == 0)
+              touched.push_back(v);
+            if(rpt != NULL) {
+              // searches reaching v for the first time record u as
+              //   predecessor; npaths needs every frontier in-neighbor
+              newbits = bits & ~next[v];
+              for( ; newbits; newbits &= newbits-1)
+                (*rpt[__builtin_ctzll(newbits)])[v].pred = u;
+              if(count_paths) {
+                for( ; bits; bits &= bits-1) {
+                  i = __builtin_ctzll(bits);
+                  add_npaths((*rpt[i])[v].npaths, (*rpt[i])[u].npaths);
+                }
+              }
+            }
+            next[v] |= visit[u] & ~seen[v];
+          }
+        }
+
+        for(int u : frontier)
+          visit[u] = 0;
+        for(int v : touched) {
+          seen[v] |= next[v];
+          visit[v] = next[v];
+          for(bits = next[v]; bits; bits &= bits-1) {
+            i = __builtin_ctzll(bits);
+            if(rpt != NULL) {
+              (*rpt[i])[v].dist = d;
+              (*rpt[i])[v].state = DISCOVERED;
+            }
+            else
+              dist[(size_t)v*stride + i] = d;
+          }
+          next[v] = 0;
+        }
+        frontier.swap(touched);
+      }
+    }
+
+  public:
+    /*
+     * func:  multi_bfs
+     * desc:  runs bfs from every vertex in sources, sharing the work:
+     *   searches are run 64 at a time with ms_bfs_batch, so that each
+     *   edge scan serves up to 64 sources.
+     *
+     *   reports[i] is the bfs report for sources[i] (dist, pred, 
+     *   state).  npaths is only computed if count_paths is true, since
+     *   it costs extra work for every search that crosses an edge; 
+     *   otherwise it is 1 at the source and 0 elsewhere.
+     *
+     * returns false (and does nothing) if any source ID is invalid.
+     */
+    bool multi_bfs(const vector<int> &sources,
+        vector<vector<vertex_label> > &reports, bool count_paths=false) {
+      int i, b, k;
+      vector<vertex_label> *rpt[64];
+
+      for(int s : sources) {
+        if(s < 0 || s >= num_nodes())
+          return false;
+      }
+      reports.resize(sources.size());
+      for(b=0; b<(int)sources.size(); b+=64) {
+        k = std::min((int)sources.size() - b, 64);
+        for(i=0; i<k; i++) {
+          init_report(reports[b+i]);
+          rpt[i] = &reports[b+i];
+        }
+        ms_bfs_batch(&sources[b], k, rpt, NULL, 0, count_paths);
+      }
+      return true;
+    }
+
+    /*
+     * func:  multi_bfs_dist
+     * desc:  compact version of multi_bfs which computes only
+     *   distances (in edges), as a num_nodes() x sources.size()
+     *   matrix stored by vertex:
+     *
+     *       dist[v*sources.size() + i] = distance from sources[i] to v
+     *                                    (-1 if v is unreachable)
+     *
+     * returns false (and does nothing) if any source ID is invalid.
+     */
+    bool multi_bfs_dist(const vector<int> &sources, vector<int> &dist) {
+      int b, k;
+
+      for(int s : sources) {
+        if(s < 0 || s >= num_nodes())
+          return false;
+      }
+      dist.assign((size_t)num_nodes()*sources.size(), -1);
+      for(b=0; b<(int)sources.size(); b+=64) {
+        k = std::min((int)sources.size() - b, 64);
+        ms_bfs_batch(&sources[b], k, NULL, &dist[b], sources.size(), false);
+      }
+      return true;
+    }
+
+    /*
+     * func:  dijkstra
+     * desc:  single-source shortest paths by edge weight (Dijkstra's
+     *   algorithm).  Fills the report like bfs does, but with weighted
+     *   distances:
+     *
+     *     report[u].dist    length (sum of weights) of a shortest path
+     *                       from src to u; -1 if u is unreachable
+     *     report[u].pred    predecessor of u on a shortest path
+     *                       (src is its own pred)
+     *     report[u].npaths  number of shortest paths from src to u
+     *     report[u].state   FINISHED for every vertex reached
+     *
+     *   The priority queue is a template parameter:  binary_heap (the
+     *   default), pairing_heap, or radix_heap (integer weights only).
+     *   See the priority queue classes above.
+     *
+     *   If settled is not NULL the number of vertices removed from the
+     *   queue is stored there.
+     *
+     * returns false if src is out of range, if any edge weight is
+     *   negative, or if the queue needs integer weights and some weight
+     *   is not an integer.
+     *
+     * NOTE:  npaths is exact when all weights are positive; zero-weight
+     *   edges between vertices at the same distance can make it low.
+     *
+     * RUNTIME:  O((V+E) log V) with binary_heap.
+     */
+    template <typename PQ = binary_heap>
+    bool dijkstra(int src, vector<vertex_label> &report,
+        long long *settled=NULL) {
+      PQ pq;
+      int u, v, i;
+      double du, nd;
+      long long nsettled = 0;
+
+      if(src < 0 || src >= num_nodes())
+        return false;
+
+      const csr &c = snapshot();
+      for(i=0; i<(int)c.out_wt.size(); i++) {
+        if(c.out_wt[i] < 0 ||
+            (PQ::integer_keys && c.out_wt[i] != std::floor(c.out_wt[i])))
+          return false;
+      }
+
+      init_report(report);
+      pq.reset(num_nodes());
+      report[src].dist = 0;
+      report[src].pred = src;
+      report[src].npaths = 1;
+      report[src].state = DISCOVERED;
+      pq.push(src, 0);
+
+      while(!pq.empty()) {
+        u = pq.pop(du);
+        report[u].state = FINISHED;
+        nsettled++;
+        for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+          v = c.out_tgt[i];
+          if(report[v].state == FINISHED)
+            continue;
+          nd = du + c.out_wt[i];
+          if(report[v].state == UNDISCOVERED || nd < report[v].dist) {
+            report[v].dist = nd;
+            report[v].pred = u;
+            report[v].npaths = report[u].npaths;
+            report[v].state = DISCOVERED;
+            pq.push(v, nd);
+          }
+          else if(nd == report[v].dist)
+            add_npaths(report[v].npaths, report[u].npaths);
+        }
+      }
+      if(settled != NULL)
+        *settled = nsettled;
+      return true;
+    }
+
+    template <typename PQ = binary_heap>
+    bool dijkstra(const string src, vector<vertex_label> &report,
+        long long *settled=NULL) {
+      int u;
+
+      if((u=name2id(src)) == -1)
+          return false;
+      return dijkstra<PQ>(u, report, settled);
+    }
+
+    /*
+     * func:  delta_stepping_auto
+     * desc:  the bucket width delta_stepping uses when it is given
+     *   delta <= 0.  With delta around (typical weight) / (average
+     *   out-degree) a bucket holds roughly one "round" of edge
+     *   relaxations' worth of distance, which keeps the number of
+     *   phases low without re-relaxing many vertices.  The typical
+     *   weight is the 90th percentile of (up to 4096 sampled) positive
+     *   weights, so a few huge weights don't make delta too coarse.
+     *
+     *   Returns 1 if the graph has no positive weights.
+     */
+    double delta_stepping_auto() {
+      const csr &c = snapshot();
+      vector<double> sample;
+      size_t m = c.out_wt.size(), step, i;
+      double avg_deg, delta;
+
+      step = std::max((size_t)1, m / 4096);
+      for(i=0; i<m; i+=step) {
+        if(c.out_wt[i] > 0)
+          sample.push_back(c.out_wt[i]);
+      }
+      if(sample.empty())
+        return 1;
+      std::nth_element(sample.begin(), sample.begin() + sample.size()*9/10,
+          sample.end());
+      avg_deg = std::max(1.0, (double)m / num_nodes());
+      delta = sample[sample.size()*9/10] / avg_deg;
+      return std::max(delta, *std::min_element(sample.begin(), sample.end()));
+    }
+
+    /*
+     * func:  delta_stepping
+     * desc:  multi-threaded single-source shortest paths (the
+     *   delta-stepping algorithm of Meyer and Sanders).  Fills the same
+     *   report as dijkstra.
+     *
+     *   Vertices are kept in buckets of width delta by tentative
+     *   distance, and the lowest non-empty bucket is settled in
+     *   parallel:
+     *
+     *     - the edges of each vertex are split into light (weight <=
+     *       delta) and heavy ones.
+     *     - light edges are relaxed from every vertex in the bucket,
+     *       by nthreads threads at once, until the bucket stays empty
+     *       (a light edge can put a vertex back in the current bucket).
+     *     - then the heavy edges of all vertices removed from the
+     *       bucket are relaxed once; they can only reach later buckets.
+     *
+     *   Distances are lowered with an atomic compare-and-swap, so
+     *   threads never lose an update.  pred and npaths are filled in
+     *   afterwards from the final distances:  pred is the first
+     *   in-neighbor on a shortest path (so it does not depend on thread
+     *   timing) and npaths is summed in order of distance.
+     *
+     *   delta <= 0 picks delta with delta_stepping_auto.  Small delta
+     *   behaves like Dijkstra (little wasted work, little
+     *   parallelism); large delta like Bellman-Ford.
+     *
+     * returns false if src is out of range or some weight is negative.
+     *
+     * NOTE:  npaths is exact when all weights are positive (see
+     *   dijkstra).
+     */
+    bool delta_stepping(int src, std::vector<vertex_label> &report,
+        double delta=0, int nthreads=0) {
+      int n = num_nodes();
+      size_t k;
+      int i, round = 0;
+
+      if(src < 0 || src >= n)
+        return false;
+
+      const csr &c = snapshot();
+      for(k=0; k<c.out_wt.size(); k++) {
+        if(c.out_wt[k] < 0)
+          return false;
+      }
+      if(delta <= 0)
+        delta = delta_stepping_auto();
+
+      worker_pool &wp = pool(nthreads);
+      vector<std::atomic<double> > dist(n);
+      vector<vector<int> > local(wp.size());
+      std::map<long long, vector<int> > buckets;
+      vector<int> light_end(n), tgt(c.out_tgt.size()), stamp(n, -1);
+      vector<double> wt(c.out_wt.size());
+      vector<int> frontier, settled, order;
+
+      // copy the edges with each vertex's light edges first
+      wp.for_blocks(n, [&](size_t lo, size_t hi, int /*tid*/) {
+        int u, i, j;
+        for(u=lo; u<(int)hi; u++) {
+          j = c.out_off[u];
+          for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+            if(c.out_wt[i] <= delta) {
+              tgt[j] = c.out_tgt[i];
+              wt[j++] = c.out_wt[i];
+            }
+          }
+          light_end[u] = j;
+          for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+            if(c.out_wt[i] > delta) {
+              tgt[j] = c.out_tgt[i];
+              wt[j++] = c.out_wt[i];
+            }
+          }
+          dist[u].store(-1, std::memory_order_relaxed);
+        }
+      }, 1024);
+
+      // relaxes edges [out_off[u], light_end[u]) (light) or
+      //   [light_end[u], out_off[u+1]) (heavy) of the given vertices;
+      //   lowered vertices go in the buckets
+      auto relax = [&](const vector<int> &from, bool heavy) {
+        wp.for_blocks(from.size(), [&](size_t lo, size_t hi, int tid) {
+          vector<int> &mine = local[tid];
+          int u, v, i, end;
+          double du, nd, old;
+
+          for(size_t k=lo; k<hi; k++) {
+            u = from[k];
+            du = dist[u].load(std::memory_order_relaxed);
+            i = heavy ? light_end[u] : c.out_off[u];
+            end = heavy ? c.out_off[u+1] : light_end[u];
+            for(; i<end; i++) {
+              v = tgt[i];
+              nd = du + wt[i];
+              old = dist[v].load(std::memory_order_relaxed);
+              while((old == -1 || nd < old) &&
+                  !dist[v].compare_exchange_weak(old, nd,
+                    std::memory_order_relaxed))
+                ;
+              if(old == -1 || nd < old)
+                mine.push_back(v);
+            }
+          }
+        }, 64);
+        for(vector<int> &mine : local) {
+          for(int v : mine)
+            buckets[(long long)(dist[v].load() / delta)].push_back(v);
+          mine.clear();
+        }
+      };
+
+      dist[src].store(0);
+      buckets[0].push_back(src);
+
+      while(!buckets.empty()) {
+        long long b = buckets.begin()->first;
+
+        settled.clear();
+        while(buckets.count(b)) {
+          // skip stale entries (the vertex moved to a lower bucket
+          //   since) and duplicates
+          frontier.clear();
+          for(int v : buckets[b]) {
+            if(stamp[v] != round &&
+                (long long)(dist[v].load() / delta) == b) {
+              stamp[v] = round;
+              frontier.push_back(v);
+            }
+          }
+          buckets.erase(b);
+          round++;
+          relax(frontier, false);
+          settled.insert(settled.end(), frontier.begin(), frontier.end());
+        }
+        relax(settled, true);
+      }
+
+      // pred, npaths and state from the final distances
+      init_report(report);
+      for(i=0; i<n; i++) {
+        report[i].dist = dist[i].load(std::memory_order_relaxed);
+        if(report[i].dist != -1)
+          order.push_back(i);
+      }
+      std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return report[a].dist < report[b].dist;
+      });
+      wp.for_blocks(n, [&](size_t lo, size_t hi, int /*tid*/) {
+        int i, v;
+        for(v=lo; v<(int)hi; v++) {
+          if(report[v].dist == -1 || v == src)
+            continue;
+          report[v].state = FINISHED;
+          for(i=c.in_off[v]; i<c.in_off[v+1]; i++) {
+            if(report[c.in_tgt[i]].dist != -1 &&
+                report[c.in_tgt[i]].dist + c.in_wt[i] == report[v].dist) {
+              report[v].pred = c.in_tgt[i];
+              break;
+            }
+          }
+        }
+      }, 1024);
+      report[src].pred = src;
+      report[src].state = FINISHED;
+      report[src].npaths = 1;
+      for(int v : order) {
+        if(v == src)
+          continue;
+        for(i=c.in_off[v]; i<c.in_off[v+1]; i++) {
+          int u = c.in_tgt[i];
+          if(report[u].dist != -1 &&
+              report[u].dist + c.in_wt[i] == report[v].dist)
+            add_npaths(report[v].npaths, report[u].npaths);
+        }
+      }
+      return true;
+    }
+
+    bool delta_stepping(const string src, std::vector<vertex_label> &report,
+        double delta=0, int nthreads=0) {
+      int u;
+
+      if((u=name2id(src)) == -1)
+          return false;
+      return delta_stepping(u, report, delta, nthreads);
+    }
+
+  private:
+    /*
+     * function:  _dfs
+     * desc:  depth-first search from u over vertices that are still
+     *   UNDISCOVERED in rpt.  A vertex is ACTIVE while it is on the
+     *   search stack and FINISHED once all of its outgoing edges have
+     *   been examined; an edge to an ACTIVE vertex means a cycle.
+     *
+     *   The search keeps its own stack (_dfs_stack) instead of
+     *   recursing, so the depth of the search is limited only by
+     *   memory -- not by the size of the call stack.
+     *
+     *   If times is not NULL, discovery/finish times are recorded in
+     *   it using (and advancing) clock.
+     */
+    void _dfs(int u, vector<vertex_label> & rpt, bool &cycle,
+        dfs_times *times=NULL, int *clock=NULL) {
+      int v, top;
+
+      if(_compressed) {
+        _dfs_packed(u, rpt, cycle, times, clock);
+        return;
+      }
+      _dfs_stack.clear();
+      _dfs_stack.push_back(std::make_pair(u, _csr.out_off[u]));
+      rpt[u].state = ACTIVE;
+      if(times != NULL)
+        times->discovery[u] = (*clock)++;
+
+      while(!_dfs_stack.empty()) {
+        top = _dfs_stack.size() - 1;
+        u = _dfs_stack[top].first;
+
+        if(_dfs_stack[top].second == _csr.out_off[u+1]) {
+          // all outgoing edges examined
+          rpt[u].state = FINISHED;
+          if(times != NULL)
+            times->finish[u] = (*clock)++;
+          _dfs_stack.pop_back();
+          continue;
+        }
+
+        v = _csr.out_tgt[_dfs_stack[top].second++];
+        if(rpt[v].state == UNDISCOVERED) {
+          rpt[v].pred = u;
+          rpt[v].dist = rpt[u].dist + 1;
+          rpt[v].state = ACTIVE;
+          if(times != NULL)
+            times->discovery[v] = (*clock)++;
+          _dfs_stack.push_back(std::make_pair(v, _csr.out_off[v]));
+        }
+        else if(rpt[v].state == ACTIVE) 
+          cycle = true;
+      }
+    }
+
+    /*
+     * function:  _dfs_packed
+     * desc:  _dfs for a compressed graph:  the same search, decoding
+     *   the outgoing lists as it goes.
+     */
+    void _dfs_packed(int u, vector<vertex_label> & rpt, bool &cycle,
+        dfs_times *times, int *clock) {
+      int v, top;
+
+      _packed_stack.clear();
+      _packed_stack.push_back(packed_frame { u, u, _packed.off[u] });
+      rpt[u].state = ACTIVE;
+      if(times != NULL)
+        times->discovery[u] = (*clock)++;
+
+      while(!_packed_stack.empty()) {
+        top = _packed_stack.size() - 1;
+        packed_frame &f = _packed_stack[top];
+        u = f.u;
+
+        if(f.pos == _packed.off[u+1]) {
+          // all outgoing edges examined
+          rpt[u].state = FINISHED;
+          if(times != NULL)
+            times->finish[u] = (*clock)++;
+          _packed_stack.pop_back();
+          continue;
+        }
+
+        v = f.prev = _packed.next(u, f.pos, f.prev);
+        if(rpt[v].state == UNDISCOVERED) {
+          rpt[v].pred = u;
+          rpt[v].dist = rpt[u].dist + 1;
+          rpt[v].state = ACTIVE;
+          if(times != NULL)
+            times->discovery[v] = (*clock)++;
+          _packed_stack.push_back(packed_frame { v, v, _packed.off[v] });
+        }
+        else if(rpt[v].state == ACTIVE) 
+          cycle = true;
+      }
+    }
+
+  public:
+    bool dfs(int u, vector<vertex_label> & rpt, bool &cycle) {
+
+      if(u < 0 || u >= num_nodes()) 
+        return false;
+
+      cycle = false;
+
+      ready_adjacency();
+      init_report(rpt);
+      rpt[u].pred = u;
+      rpt[u].dist = 0;
+      _dfs(u, rpt, cycle);
+      return true;
+    }
+
+    /*
+     * func:  dfs (with times)
+     * desc:  same as dfs above, but also records the discovery and 
+     *   finish time of every vertex reached (see dfs_times).
+     */
+    bool dfs(int u, vector<vertex_label> & rpt, bool &cycle,
+        dfs_times &times) {
+      int clock = 0;
+
+      if(u < 0 || u >= num_nodes()) 
+        return false;
+
+      cycle = false;
+
+      ready_adjacency();
+      init_report(rpt);
+      times.discovery.assign(num_nodes(), -1);
+      times.finish.assign(num_nodes(), -1);
+      rpt[u].pred = u;
+      rpt[u].dist = 0;
+      _dfs(u, rpt, cycle, &times, &clock);
+      return true;
+    }
+
+    bool dfs(const string &src, vector<vertex_label> & rpt, bool &cycle) {
+      int u;
+
+      if((u=name2id(src)) == -1)
+          return false;
+      dfs(u, rpt, cycle);
+      return true;
+    }
+
+  private:
+    // forget the cached DAG information (after any change to the edges)
+    void dag_changed() {
+      _dag_status = '?';
+      _level_off.clear();
+      _level_vtx.clear();
+    }
+
+    /*
+     * function:  dag_levels
+     * desc:  groups the vertices of a DAG by topological level:  the
+     *   level of an input vertex is 0, and the level of any other
+     *   vertex is one more than the largest level of its in-neighbors.
+     *   So all in-neighbors of a vertex are at lower levels, and the
+     *   vertices within one level don't depend on each other.
+     *
+     *   Fills (and caches) _level_off/_level_vtx.  Returns false if
+     *   the graph has a cycle.
+     */
+    bool dag_levels() {
+      const vector<int> *ord = dag_order();
+      vector<int> level;
+      int i, nlevels = 0;
+
+      if(ord == NULL)
+        return false;
+      if(!_level_off.empty())
+        return true;
+
+      const csr &c = snapshot();
+      level.assign(num_nodes(), 0);
+      for(int u : *ord) {
+        for(i=c.out_off[u]; i<c.out_off[u+1]; i++)
+          level[c.out_tgt[i]] = std::max(level[c.out_tgt[i]], level[u]+1);
+        nlevels = std::max(nlevels, level[u]+1);
+      }
+
+      // counting sort of the vertices by level (removed vertices are
+      //   not in the order, and get no level)
+      _level_off.assign(nlevels+1, 0);
+      for(int u : *ord)
+        _level_off[level[u]+1]++;
+      for(i=0; i<nlevels; i++)
+        _level_off[i+1] += _level_off[i];
+      _level_vtx.resize(ord->size());
+      for(int u : *ord)
+        _level_vtx[_level_off[level[u]]++] = u;
+      for(i=nlevels; i>0; i--)
+        _level_off[i] = _level_off[i-1];
+      _level_off[0] = 0;
+      return true;
+    }
+
+    /*
+     * function:  dag_order
+     * desc:  returns a topological order of the graph, or NULL if the
+     *   graph has a cycle.
+     *
+     *   The answer is computed with a single pass of Kahn's algorithm
+     *   (repeatedly remove a vertex with no remaining incoming edges):
+     *   if that runs out of such vertices before every vertex has been
+     *   ordered, the remaining vertices are on or behind a cycle.
+     *
+     *   The result is cached until the graph changes, so asking again
+     *   (has_cycle, topo_sort and the dag_* functions all do) is free.
+     */
+    const vector<int> * dag_order() {
+      std::queue<int> q;
+      std::vector<int> indegrees;
+      int u;
+
+      if(_dag_status == '?') {
+        ready_adjacency();
+
+        _topo_order.clear();
+        indegrees.assign(num_nodes(), 0);
+        for(u=0; u<num_nodes(); u++) {
+          if(_compressed)
+            for_each_out(u, [&](int v) { indegrees[v]++; });
+          else
+            indegrees[u] = _csr.in_off[u+1] - _csr.in_off[u];
+        }
+        for(u=0; u<num_nodes(); u++) {
+          if(indegrees[u]==0 && (_dead_vertices == 0 || !is_removed(u)))
+            q.push(u);
+        }
+
+        while(!q.empty()){
+          u = q.front();
+          q.pop();
+          _topo_order.push_back(u);
+          for_each_out(u, [&](int v) {
+            indegrees[v]--;
+            if(indegrees[v]==0) 
+              q.push(v);
+          });
+        }
+
+        if((int)_topo_order.size() < num_nodes() - _dead_vertices) {
+          _topo_order.clear();
+          _dag_status = 'n';
+        }
+        else
+          _dag_status = 'y';
+      }
+      return _dag_status == 'y' ? &_topo_order : NULL;
+    }
+
+  public:
+    bool has_cycle() {
+      return dag_order() == NULL;
+    }
+
+    bool topo_sort(std::vector<int> &order) {
+      const vector<int> *ord = dag_order();
+
+      order.clear();
+      if(ord == NULL)
+        return false;
+      order = *ord;
+      return true;
+    }
+
+    /*
+     * func:  scc
+     * desc:  strongly connected components (Tarjan's algorithm):  two
+     *   vertices are in the same component iff each can reach the
+     *   other.  On return comp[u] is the component ID of vertex u.
+     *
+     *   Components are numbered in topological order:  if there is an
+     *   edge from a vertex in component a to a vertex in a different
+     *   component b, then a < b.
+     *
+     *   Like dfs, the search keeps its own stack (_dfs_stack) instead
+     *   of recursing.
+     *
+     * returns the number of components.
+     *
+     * RUNTIME:  O(V+E)
+     */
+    int scc(vector<int> &comp) {
+      vector<int> index, low, stk;
+      vector<char> on_stack;
+      int n = num_nodes(), u, v, w, top, r, next = 0, ncomp = 0;
+
+      const csr &c = snapshot();
+      index.assign(n, -1);
+      low.assign(n, 0);
+      on_stack.assign(n, 0);
+      comp.assign(n, -1);
+
+      for(r=0; r<n; r++) {
+        if(index[r] != -1)
+          continue;
+        _dfs_stack.clear();
+        _dfs_stack.push_back(std::make_pair(r, c.out_off[r]));
+        index[r] = low[r] = next++;
+        stk.push_back(r);
+        on_stack[r] = 1;
+
+        while(!_dfs_stack.empty()) {
+          top = _dfs_stack.size() - 1;
+          u = _dfs_stack[top].first;
+
+          if(_dfs_stack[top].second < c.out_off[u+1]) {
+            v = c.out_tgt[_dfs_stack[top].second++];
+            if(index[v] == -1) {
+              index[v] = low[v] = next++;
+              stk.push_back(v);
+              on_stack[v] = 1;
+              _dfs_stack.push_back(std::make_pair(v, c.out_off[v]));
+            }
+            else if(on_stack[v])
+              low[u] = std::min(low[u], index[v]);
+            continue;
+          }
+
+          // all outgoing edges examined:  u is the root of a
+          //   component iff nothing below it reaches higher up
+          _dfs_stack.pop_back();
+          if(top > 0)
+            low[_dfs_stack[top-1].first] =
+              std::min(low[_dfs_stack[top-1].first], low[u]);
+          if(low[u] == index[u]) {
+            do {
+              w = stk.back();
+              stk.pop_back();
+              on_stack[w] = 0;
+              comp[w] = ncomp;
+            } while(w != u);
+            ncomp++;
+          }
+        }
+      }
+
+      // Tarjan finds the components sinks first; reverse the numbering
+      for(u=0; u<n; u++)
+        comp[u] = ncomp - 1 - comp[u];
+      return ncomp;
+    }
+
+    /*
+     * func:  condensation
+     * desc:  builds the condensation of the graph in dag:  one vertex
+     *   per strongly connected component, and an edge from component a
+     *   to component b if the graph has any edge from a vertex of a to
+     *   a vertex of b.  The condensation is always a DAG, so topo_sort
+     *   and the dag_* functions work on it even when the graph itself
+     *   has cycles.
+     *
+     *   Whatever dag held before is replaced.  comp is filled as by
+     *   scc, and component c is vertex c of dag (so dag's vertex IDs
+     *   are in topological order).  Each component is named after its
+     *   lowest-ID member.
+     *
+     *   Parallel edges between two components are merged into one
+     *   edge with the largest of their weights, so dag_critical_paths
+     *   on dag gives longest path lengths; edges inside a component
+     *   are dropped.  dag_num_paths on dag counts paths of components,
+     *   not of vertices.
+     *
+     * RUNTIME:  O(V+E)
+     */
+    void condensation(graph &dag, vector<int> &comp) {
+      vector<int> off, members, last, pos;
+      vector<std::pair<int, double> > out;
+      int n = num_nodes(), ncomp, a, u, i, k;
+
+      ncomp = scc(comp);
+      const csr &c = snapshot();
+
+      // counting sort of the vertices by component
+      off.assign(ncomp+1, 0);
+      for(u=0; u<n; u++)
+        off[comp[u]+1]++;
+      for(a=0; a<ncomp; a++)
+        off[a+1] += off[a];
+      members.resize(n);
+      pos.assign(off.begin(), off.end()-1);
+      for(u=0; u<n; u++)
+        members[pos[comp[u]]++] = u;
+
+      dag = graph();
+      dag.vertices.reserve(ncomp);
+      for(a=0; a<ncomp; a++) {
+        name_view v = _names.get(members[off[a]]);
+        dag.vertex_id(v.data(), v.size());
+      }
+
+      // out collects the edges leaving component a; last[b] == a means
+      //   there already is one to b, at out[pos[b]]
+      last.assign(ncomp, -1);
+      pos.assign(ncomp, 0);
+      for(a=0; a<ncomp; a++) {
+        out.clear();
+        for(k=off[a]; k<off[a+1]; k++) {
+          u = members[k];
+          for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+            int b = comp[c.out_tgt[i]];
+            if(b == a)
+              continue;
+            if(last[b] != a) {
+              last[b] = a;
+              pos[b] = out.size();
+              out.push_back(std::make_pair(b, c.out_wt[i]));
+            }
+            else
+              out[pos[b]].second = std::max(out[pos[b]].second, c.out_wt[i]);
+          }
+        }
+        for(const std::pair<int, double> &e : out)
+          dag.insert_edge(a, e.first, e.second);
+      }
+    }
+
+
+
+    void disp_report(const vector<vertex_label> & rpt, bool print_paths=false) {
+      int u;
+      vector<int> path;
+
+        // THIS if STATEMENT IS NEW
+        if(rpt.size() != num_nodes()) {
+          std::cerr << "error - disp_report(): report vector has incorrect length\n";
+          return;
+        }
+
+        for(u=0; u<num_nodes(); u++) {
+          if(is_removed(u))
+            continue;
+          std::cout << id2name(u) << " : dist=" <<  rpt[u].dist
+            << " ; pred=" <<  id2name(rpt[u].pred) << 
+            " ; state='" << rpt[u].state << "'; npaths=" << 
+            rpt[u].npaths << "\n";
+          if(print_paths) {
+            extract_path(rpt, u, path);
+            std::cout << "     PATH: <" + id_vec2string(path) + ">\n";
+          }
+        }
+    }
+
+    /******************************************************
+     *
+     * Vocabulary:  
+     *
+     *   In a DAG G:
+     *   
+     *       inputs:  subset of vertices with INDEGREE ZERO
+     *
+     *       outputs: subset of vertices with OUTDEGREE ZERO
+     *
+     *       input-path: a path in G STARTING AT AN INPUT VERTEX
+     *          (and ending at any vertex).
+     *
+     *       output-path:  a path in G starting at any vertex and
+     *          ENDING AT AN OUTPUT VERTEX.
+     *
+     *       input-output-path (or io-path):  a path STARTING AT
+     *          AN INPUT VERTEX _AND_ ENDING AT AN OUTPUT VERTEX.
+     *
+     */
+
+    /* TODO 20 points
+     * function:  extract_path
+     * desc:  extracts the path (if any) encoded by vertex labels
+     *        ending at vertex dest (as an int ID).  Resulting path
+     *        is stored in the int vector path (sequence of vertex
+     *        IDs ENDING WITH dest -- i.e., in "forward order").
+     *
+     *     parameters:
+     *       rpt:  vector of vertex labels associated with given
+     *             graph (calling object).  Presumption:  labels
+     *             have been previously populated by another function
+     *             like bfs, dfs, or critical_paths.
+     *
+     *       dest: vertex ID of the target/destination vertex.
+     *
+     *       path: int vector in which the constructed path is stored.
+     *
+     * returns:  true on success; false otherwise.
+     *           failure:  there is no encoded path ending at vertex
+     *              dest (see discussion below);
+     *              OR, the rpt vector is not of the correct dimension.
+     *
+     * Notes:  predecessor conventions:
+     *
+     *      SOURCE VERTICES:
+     *
+     *         if vertex u is a "source" vertex such as:
+     *
+     *             the source vertex of BFS or DFS or
+     *             an input vertex in a DAG (perhaps analyzed by 
+     *                dag_critical_paths).
+     *
+     *         then the predecessor of u is u itself:
+     *
+     *              rpt[u].pred==u
+     *
+     *      UNREACHABLE VERTICES:
+     *
+     *          if rpt[u].pred == -1, this indicates that THERE IS 
+     *          NO PATH ENDING AT VERTEX u.
+     *
+     *          In this situation, the path vector is made empty and
+     *          false is returned.
+     *
+     *  RUNTIME:  O(|p|) where |p| is the number of edges on 
+     *    the path extracted.
+     *
+     */
+    bool extract_path(const vector<vertex_label> & rpt, int dest, vector<int> & path) {
+      path.clear();
+      if(rpt.size() != num_nodes())
+      {
+          return false;
+      }
+      
+      if(rpt[dest].pred ==-1)
+      {
+          path.clear();
+           return false;
+      }
+
+      // walk back to the source, then put the path in forward order
+      //   (a loop rather than recursion: dfs paths can be very long)
+      while(rpt[dest].pred != dest)
+      {
+          path.push_back(dest);
+          dest = rpt[dest].pred;
+      }
+      path.push_back(dest);
+      std::reverse(path.begin(), path.end());
+
+      return true;
+    }
+
+    /*
+     *  TODO 30 points
+     *
+     *  func: dag_critical_paths
+     *  desc: for each vertex u, the length of the critical (LONGEST)
+     *        input-path ENDING AT u.
+     *
+     *        The "length" of a path is the SUM OF THE WEIGHTS OF THE
+     *        EDGES ON THE PATH.
+     *
+     *        On completion, the results are stored in the vector rpt.
+     *        For each vertex u (as an intID),
+     *
+     *          rpt[u].dist  stores the length of the longest (critical)
+     *            input-path ending at vertex u.
+     *
+     *          rpt[u].pred  stores the predecessor vertex of u on a 
+     *            critical/longest input path ending at u.  If there
+     *            are multiple such paths (having equal maximum length)
+     *            there may be multiple correct predecessors.
+     *
+     *  returns:  true on success (as long as graph is a DAG).
+     *            false if graph is not a DAG.
+     *
+     *  runtime:  O(V+E)
+     */
+    bool dag_critical_paths(vector<vertex_label> & rpt) {
+
+      const vector<int> *ord = dag_order();
+      if(ord == NULL)
+      {
+          return false;
+      }
+      const std::vector<int> &id_order = *ord;
+      int u, v, i;
+      std::queue<int> q;
+      const csr &c = snapshot();
+
+      // (every vertex removed:  nothing is in the order)
+      if(id_order.empty())
+      {
+          init_report(rpt);
+          return true;
+      }
+      int src = id_order[0];
+      if (src < 0 || src >= num_nodes())
+      {
+          return false;
+      }
+          
+
+      init_report(rpt);
+
+      rpt[src].dist = 0;
+
+      rpt[src].pred = src;
+      rpt[src].npaths++;
+      rpt[src].state = DISCOVERED;
+      q.push(src);
+      for(i=1;i< id_order.size();i++)
+      {
+          src = id_order[i];
+          q.push(src);
+
+      }
+      while (!q.empty()) {
+          u = q.front();
+          q.pop();
+
+          if(c.in_off[u+1] == c.in_off[u])
+          {
+              rpt[u].dist = 0;
+              rpt[u].pred = u;
+              rpt[u].npaths++;
+              rpt[u].state = DISCOVERED;
+          }
+          
+          for (i = c.out_off[u]; i < c.out_off[u+1]; i++) {
+              v = c.out_tgt[i];
+              if (rpt[v].dist < rpt[u].dist + c.out_wt[i])
+              {
+                  add_npaths(rpt[v].npaths, rpt[u].npaths);
+                  rpt[v].dist = rpt[u].dist + c.out_wt[i];
+                  rpt[v].pred = u;
+                  rpt[v].state = DISCOVERED;
+              }
+                      
+          }
+          
+      }
+     
+      return true;
+    }
+
+    /*
+     *  func: dag_critical_paths_par
+     *  desc: multi-threaded version of dag_critical_paths producing the
+     *        same dist values.  Uses nthreads threads (<= 0: one per
+     *        hardware thread).
+     *
+     *        The vertices are grouped by topological level (see
+     *        dag_levels; computed once and cached).  Levels are done
+     *        one after another as "wavefronts"; within a level the
+     *        vertices are split among the threads and each vertex v
+     *        PULLS its result from its in-neighbors (all of which are
+     *        at lower levels and therefore done):
+     *
+     *          rpt[v].dist = max over edges (u,v) of rpt[u].dist + weight
+     *
+     *        Only v's own label is written, so no locking is needed.
+     *
+     *        Ties:  rpt[v].pred is the in-neighbor with the SMALLEST
+     *        vertex ID among those giving the maximum, so results are
+     *        the same from run to run and for any number of threads.
+     *        Input vertices have dist 0 and are their own pred.
+     *
+     *  returns:  true on success (as long as graph is a DAG).
+     *            false if graph is not a DAG.
+     *
+     *  runtime:  O(V+E) work; one synchronization per level.
+     */
+    bool dag_critical_paths_par(vector<vertex_label> & rpt, int nthreads=0) {
+      int L;
+
+      if(!dag_levels())
+        return false;
+
+      const csr &c = snapshot();
+      worker_pool &wp = pool(nthreads);
+      init_report(rpt);
+
+      for(L=0; L+1<(int)_level_off.size(); L++) {
+        const int *lvl = &_level_vtx[_level_off[L]];
+
+        wp.for_blocks(_level_off[L+1] - _level_off[L],
+            [&](size_t lo, size_t hi, int /*tid*/) {
+          int i, u, v;
+          double cand;
+
+          for(size_t k=lo; k<hi; k++) {
+            v = lvl[k];
+            vertex_label &lbl = rpt[v];
+            lbl.state = DISCOVERED;
+            if(c.in_off[v] == c.in_off[v+1]) {
+              lbl.dist = 0;
+              lbl.pred = v;
+              continue;
+            }
+            for(i=c.in_off[v]; i<c.in_off[v+1]; i++) {
+              u = c.in_tgt[i];
+              cand = rpt[u].dist + c.in_wt[i];
+              if(lbl.pred == -1 || cand > lbl.dist ||
+                  (cand == lbl.dist && u < lbl.pred)) {
+                lbl.dist = cand;
+                lbl.pred = u;
+              }
+            }
+          }
+        }, 256);
+      }
+      return true;
+    }
+
+    /*
+     *  TODO 30 points
+     *  function:  dag_num_paths
+     *  desc:  if given graph (calling object) is a DAG, the vector
+     *         rpt is populated such that:
+     *
+     *           rpt[u].npaths = number of io-paths passing through
+     *                            vertex u.
+     *
+     *           Recall: an IO path starts at an input vertex and
+     *             ends at an output vertex.
+     *
+     *           This value is defined for all vertices u in the
+     *             graph (inputs, outputs and "intermediate" nodes).
+     *
+     *  NOTES:  rpt[u].pred, and rpt[u].dist have no partiular 
+     *          meaning after this operation.
+     *
+     *  EXAMPLE:
+
+                         a  b  c
+                         \  |  /
+                          \ | /
+                            d
+                           / \
+                          e   f
+                           \ /
+                            g
+                           / \
+                          h   i
+                           \ /
+                            j
+
+            There are 3 input nodes (a,b,c) and one output node (j)
+            in this graph.
+
+            There are 12 distinct io-paths passing through vertex d in 
+            this dag (note:  edges are pointed downward)
+
+            Can you enumerate them?
+
+     *
+     *  returns true if graph is a DAG; false otherwise.        
+     *
+     *  RUNTIME:  O(V+E)  -- Note: in general, the number of paths
+     *                       in a graph may be exponential in the
+     *                       number of vertices.
+     *
+     *                       This means that you cannot explicitly
+     *                       enumerate all of the paths and count them!
+     *                       (The enum_paths function below which DOES
+     *                       enumerate a set of paths MAY take exponential
+     *                       time).
+     *
+     * General Hint:  an io-path passing through a vertex u is 
+     *   composed of an input-path ending at u, followed by an
+     *   output path starting at u.  
+     *
+     *   Now, if you could figure out the number of input-paths
+     *   ending at u and the number of output paths starting at u, 
+     *   could you determine the number of io-paths passing through
+     *   u?
+     *
+     */
+    bool dag_num_paths(vector<vertex_label>& rpt) 
+    {
+        vector<sat_count128> counts;
+
+        if (!dag_num_paths(counts))
+        {
+            return false;
+        }
+
+        // counts that don't fit in npaths are clamped to LLONG_MAX
+        init_report(rpt);
+        for (int u = 0; u < num_nodes(); u++)
+        {
+            rpt[u].npaths = counts[u].clamp();
+        }
+        return true;
+    }
+
+    /*
+     *  func: dag_num_paths (templated on the counter type)
+     *  desc: same as dag_num_paths above, but the counts are computed
+     *        in type C and returned in npaths (indexed by vertex ID):
+     *
+     *          npaths[u] = number of io-paths passing through vertex u
+     *                      (0 for a removed vertex)
+     *
+     *        The number of paths grows exponentially with the depth of
+     *        a DAG, so pick C for what the counts are needed for:
+     *
+     *          uint64_t       exact below 2^64 (wraps around silently)
+     *          sat_count128   exact below 2^128; saturated() otherwise
+     *          mod_count<P>   exact count modulo prime P (fingerprints /
+     *                          hashing; equal counts give equal residues)
+     *          log_count      natural log of the count, as a double
+     *                          (approximate, but never overflows)
+     *
+     *        C must be constructible from 0 and 1 and support += and *.
+     *
+     *        Two sweeps over the topological order, both written as
+     *        "pull" loops over the CSR arrays:
+     *
+     *          forward:  in[u]  = 1 if u is an input, otherwise the sum
+     *                    of in[p] over u's in-neighbors p
+     *                    (input-paths ending at u)
+     *          backward: out[u] = 1 if u is an output, otherwise the sum
+     *                    of out[q] over u's out-neighbors q
+     *                    (output-paths starting at u)
+     *
+     *        and then npaths[u] = in[u] * out[u].  Each vertex writes
+     *        only its own entry, summing its neighbors' entries over a
+     *        contiguous range of the CSR arrays (see gather_sum), with no
+     *        scattered stores.  The neighbors' entries are read in
+     *        random order, so the sweeps are bound by memory loads:
+     *        SIMD gathers (-march=native) make no measurable difference,
+     *        and uint64_t, sat_count128 and mod_count_m61 take about
+     *        1, 1.3 and 1.15 times as long (see bench_paths).  log_count
+     *        sums with one exp per term and takes about 6 times as long.
+     *
+     *  returns true if graph is a DAG; false otherwise.
+     *
+     *  RUNTIME:  O(V+E) counter operations.
+     */
+    template <typename C>
+    bool dag_num_paths(vector<C> &npaths) {
+      const vector<int> *ord = dag_order();
+      int k, u, lo, hi, n = num_nodes(), nord;
+
+      if(ord == NULL)
+        return false;
+
+      // (removed vertices are not in the order; they keep in = out = 0)
+      const csr &c = snapshot();
+      const int *order = ord->data();
+      vector<C> in(n, C(0)), out(n, C(0));
+
+      nord = ord->size();
+      for(k=0; k<nord; k++) {
+        u = order[k];
+        lo = c.in_off[u];
+        hi = c.in_off[u+1];
+        in[u] = lo == hi ? C(1) : gather_sum(in.data(), c.in_tgt.data(), lo, hi);
+      }
+
+      for(k=nord-1; k>=0; k--) {
+        u = order[k];
+        lo = c.out_off[u];
+        hi = c.out_off[u+1];
+        out[u] = lo == hi ? C(1) : gather_sum(out.data(), c.out_tgt.data(), lo, hi);
+      }
+
+      npaths.resize(n);
+      for(u=0; u<n; u++)
+        npaths[u] = in[u] * out[u];
+      return true;
+    }
+
+    /*
+     * TODO 20 points
+     * function:  valid_topo_order
+     * desc:  determines if vertex sequence in the given vector
+     *        (parameter order) is a valid topological ordering of
+     *        the given graph (calling object).
+     *
+     *        returns true if it is; false otherwise.
+     *
+     * details:  returns false if graph is not a DAG.
+     *
+     *           Note that vertices are given as their integer IDs.
+     *
+     * RUNTIME:  O(V+E)
+     */
+    bool valid_topo_order(const vector<int> & order) {
+      if(has_cycle())
+      {
+          return false;
+      }
+      std::vector<bool> Visited(num_nodes(), false);
+      int u, v;
+      const csr &c = snapshot();
+       
+       for(int i = 0; i<order.size();i++)
+       {
+           u = order[i];
+           if(c.in_off[u+1] == c.in_off[u])
+           {
+               Visited[u] = true;
+           }
+           else
+           {
+               for(int j = c.in_off[u]; j< c.in_off[u+1]; j++)
+               {
+                   v = c.in_tgt[j];
+                   if(Visited[v] == false)
+                   {
+                       return false;
+                   }
+               }
+              Visited[u] = true;
+           }
+       }
+      return true;
+
+    }
+
+    /*
+     * TODO 30 points
+     *
+     * function:  enum_paths
+     * desc:  enumerates all input-paths ending at target vertes in
+     *        a DAG.
+     * details:  Given a DAG and vertex target in the graph, the
+     *   vector paths is populated with ALL input paths ending at
+     *   vertex target.
+     *
+     * [NOTE:  target vertex is passed as its integer ID; however,
+     *   vertices in paths constructed are represented by their 
+     *   name -- as a string]
+     *
+     * A path is represented as a string containing the names of
+     * each vertex (NOT intger vertex IDs) on the path in sequence; 
+     * vertex names are separated by a single space.
+     *
+     * returns:  true on success; 
+     *           false on failure (graph is not a DAG or target vertex ID
+     *           is out of range).
+     *
+     * RUNTIME:  this one may be unavoidably exponential!
+     *
+     * EXAMPLES:
+     *
+     *   Chicago
+     *   NewYork
+     *   LosAngeles
+     *
+     * and there are edges:
+     *
+     *   LosAngeles Chicago
+     *   Chicago NewYork
+     *
+     * The path LosAngeles to Chicago to NewYork is represented by the
+     * string:
+     *
+     *   "LosAngeles Chicago NewYork"
+     *
+     * Another example:  the input file ex1A is a DAG.  Using vertex g
+     * as the target (integer ID: 6), will result in the paths vector
+     * containing the following strings:
+     *
+
+           "a d g"
+           "a b d g"
+           "a c d g"
+           "a d e g"
+           "a b d e g"
+           "a c d e g"
+           "a d f g"
+           "a b d f g"
+           "a c d f g"
+     *
+     * NOTE:  the concatenation operator '+' on strings might
+     *   make some of your work pretty easy to code!
+     *
+     * COMMENT:  this function can be implemented with about
+     *   20 lines of code.
+     */
+    bool enum_paths(int target, vector<string> &paths) {
+      path_enumerator it;
+
+      paths.clear();
+      if(!input_paths(target, it))
+      {
+          return false;
+      }
+      while(it.next())
+      {
+          paths.push_back(path_string(it.path()));
+      }
+      return true;
+    }
+
+    /*
+     * class:  path_enumerator
+     * desc:   produces the input-paths ending at a vertex of a DAG one
+     *   at a time (see input_paths), instead of building all of them
+     *   up front like enum_paths does:
+     *
+     *       graph::path_enumerator it;
+     *
+     *       if(g.input_paths(target, it)) {
+     *         while(it.next()) {
+     *           ... it.path() ...
+     *         }
+     *       }
+     *
+     *   it.path() is the current path as vertex IDs, in forward order
+     *   (input vertex first, target last).  It is only valid until the
+     *   next call to next().  The caller can stop at any time.
+     *
+     *   Paths come out in the same order as from enum_paths.  The
+     *   enumerator does a depth-first search backwards along incoming
+     *   edges, keeping only the current path on an explicit stack, so
+     *   memory is O(length of the longest path) no matter how many
+     *   paths there are.
+     *
+     *   The graph must not be changed while an enumerator is in use.
+     */
+    class path_enumerator {
+
+      friend class graph;
+
+      private:
+        const csr *c;
+        // stack[k] = (vertex, index of its next incoming edge to try);
+        //   stack[0] is the target
+        vector<std::pair<int, int> > stack;
+        vector<int> fwd;
+        bool started;
+
+      public:
+        path_enumerator() : c { NULL }, started { false } { }
+
+        /*
+         * advances to the next path.  Returns false when there are no
+         *   more paths.
+         */
+        bool next() {
+          int v, u, top;
+
+          if(c == NULL)
+            return false;
+          if(started && !stack.empty())
+            stack.pop_back();   // input vertex ending the last path
+          started = true;
+
+          while(!stack.empty()) {
+            top = stack.size() - 1;
+            v = stack[top].first;
+            if(c->in_off[v] == c->in_off[v+1]) {
+              // reached an input vertex:  the stack holds a path
+              fwd.clear();
+              for( ; top >= 0; top--)
+                fwd.push_back(stack[top].first);
+              return true;
+            }
+            if(stack[top].second == c->in_off[v+1]) {
+              stack.pop_back();
+              continue;
+            }
+            u = c->in_tgt[stack[top].second++];
+            stack.push_back(std::make_pair(u, c->in_off[u]));
+          }
+          c = NULL;
+          return false;
+        }
+
+        const vector<int> & path() const {
+          return fwd;
+        }
+    };
+
+    /*
+     * func:  input_paths
+     * desc:  sets up it to enumerate the input-paths ending at vertex
+     *   target (see path_enumerator).
+     *
+     * returns:  false if the graph is not a DAG or target is out of
+     *   range (and it produces no paths); true otherwise.
+     */
+    bool input_paths(int target, path_enumerator &it) {
+      it.c = NULL;
+      it.stack.clear();
+      it.started = false;
+      if(has_cycle() || target < 0 || target >= num_nodes())
+        return false;
+      it.c = &snapshot();
+      it.stack.push_back(std::make_pair(target, it.c->in_off[target]));
+      return true;
+    }
+
+    /*
+     * func:  enum_paths (streaming)
+     * desc:  like enum_paths(int, vector<string> &), but each path is
+     *   written to os as soon as it is found (one per line, in the same
+     *   format) instead of being collected, so it works on graphs with
+     *   far too many paths to hold in memory.  At most limit paths are
+     *   written (limit < 0: no limit).
+     *
+     * returns:  the number of paths written; -1 if the graph is not a
+     *   DAG or target is out of range.
+     */
+    long long enum_paths(int target, std::ostream &os, long long limit=-1) {
+      path_enumerator it;
+      long long count = 0;
+
+      if(!input_paths(target, it))
+        return -1;
+      while(count != limit && it.next()) {
+        os << path_string(it.path()) << "\n";
+        count++;
+      }
+      return count;
+    }
+
+    long long enum_paths(const string &target, std::ostream &os,
+        long long limit=-1) {
+      int tgt;
+      if((tgt=name2id(target)) == -1)
+          return -1;
+
+      return enum_paths(tgt, os, limit);
+    }
+
+  private:
+    // names of the vertices on path, each followed by a space
+    //   (the path format of enum_paths)
+    string path_string(const vector<int> &path) {
+      string s;
+      size_t len = 0;
+
+      for(int u : path)
+        len += _names.get(u).size() + 1;
+      s.reserve(len);
+      for(int u : path) {
+        name_view v = _names.get(u);
+        s.append(v.data(), v.size());
+        s += ' ';
+      }
+      return s;
+    }
+
+  public:
+
+    /*
+     * (DONE)
+     * func: enum_paths(string, vector<string> &)
+     * desc: same as enum_paths(int, vector<string> &) above except
+     *       target vertex is taken as its name (as a string).
+     *
+     *       Simply translates target vertex name to its integer id
+     *       and calls enum_paths(int, vector<string> &) above.
+     */
+    bool enum_paths(const string &target,  vector<string> &paths) {
+      int tgt;
+      if((tgt=name2id(target)) == -1)
+          return false;
+
+      return enum_paths(tgt, paths);
+    }
+    
+
+
+
+};
+
+
+
+/*
+ * class:  dynamic_topo
+ *
+ * desc:   maintains a topological order of a DAG while edges are
+ *   added to it one at a time, without re-sorting the whole graph
+ *   after every insertion (algorithm of Pearce and Kelly).
+ *
+ *   Usage:  build a dynamic_topo for a graph, then add edges through
+ *     it instead of through the graph:
+ *
+ *        graph g;
+ *        ...
+ *        dynamic_topo dt(g);
+ *        dt.add_edge("compile", "link");
+ *        dt.order(ids);
+ *
+ *   Each vertex has a position; the order is valid as long as every
+ *   edge (x,y) has position(x) < position(y).  When a new edge (x,y)
+ *   breaks that rule, only the "affected region" -- vertices whose
+ *   positions are between position(y) and position(x) -- is searched:
+ *
+ *     forward from y, over vertices positioned before x:  if x is
+ *       reached, the edge would close a cycle and is rejected (the
+ *       graph is left unchanged);
+ *     backward from x, over vertices positioned after y.
+ *
+ *   The vertices found backward (x and what leads to it) are then
+ *   moved in front of the ones found forward (y and what it leads
+ *   to), reusing the same set of positions.
+ *
+ *   New vertices are placed at the front (if they are the source of
+ *   the new edge) or the back (destination), so they never break the
+ *   order.
+ *
+ *   If the graph is changed other than through the dynamic_topo --
+ *   vertices or edges added or removed directly, or the vertices
+ *   renumbered by compact or reorder -- the next call notices (as
+ *   reach_index does) and builds the order again from the graph, in
+ *   O(V+E).
+ *
+ *   Adjacency is read from the graph's per-vertex edge lists, so each
+ *   insertion costs time proportional to the affected region, not
+ *   O(V+E).  If the graph has been frozen (or compressed) since, the
+ *   next add_edge thaws it first.
+ */
+class dynamic_topo {
+
+  private:
+    graph &g;
+    bool ok;                  // false if g had a cycle to begin with
+    vector<int> ord;          // ord[v]:  position of v (+ base)
+    std::deque<int> at;       // at[p]:  vertex at position p (- base)
+    int base;                 // ord of the first position
+    int n, m;                 // g's vertex and edge counts and
+    unsigned relabels;        //   g._relabels as of the last update
+
+    // work space for searches
+    vector<char> mark;
+    vector<int> fwd, bwd, stk;
+
+    void place_back(int v) {
+      ord.push_back(base + at.size());
+      at.push_back(v);
+      mark.push_back(0);
+    }
+
+    void place_front(int v) {
+      ord.push_back(--base);
+      at.push_front(v);
+      mark.push_back(0);
+    }
+
+    // forward search from y over vertices with ord < ub; returns false
+    //   if the vertex with ord ub (i.e., x) is reached.
+    bool search_forward(int y, int ub) {
+      int u;
+
+      stk.assign(1, y);
+      mark[y] = 1;
+      while(!stk.empty()) {
+        u = stk.back();
+        stk.pop_back();
+        fwd.push_back(u);
+        for(graph::edge &e : g.vertices[u].outgoing) {
+          if(e.vertex_id == -1)
+            continue;
+          if(ord[e.vertex_id] == ub)
+            return false;
+          if(!mark[e.vertex_id] && ord[e.vertex_id] < ub) {
+            mark[e.vertex_id] = 1;
+            stk.push_back(e.vertex_id);
+          }
+        }
+      }
+      return true;
+    }
+
+    // backward search from x over vertices with ord > lb
+    void search_backward(int x, int lb) {
+      int u;
+
+      stk.assign(1, x);
+      mark[x] = 1;
+      while(!stk.empty()) {
+        u = stk.back();
+        stk.pop_back();
+        bwd.push_back(u);
+        for(graph::edge &e : g.vertices[u].incoming) {
+          if(e.vertex_id != -1 && !mark[e.vertex_id] && ord[e.vertex_id] > lb) {
+            mark[e.vertex_id] = 1;
+            stk.push_back(e.vertex_id);
+          }
+        }
+      }
+    }
+
+    bool by_ord(int a, int b) const {
+      return ord[a] < ord[b];
+    }
+
+    // moves bwd (in its current relative order) in front of fwd,
+    //   reusing the positions the two sets occupy now
+    void reorder() {
+      vector<int> slots;
+      size_t i;
+      auto cmp = [this](int a, int b) { return by_ord(a, b); };
+
+      std::sort(bwd.begin(), bwd.end(), cmp);
+      std::sort(fwd.begin(), fwd.end(), cmp);
+      for(int v : bwd)
+        slots.push_back(ord[v]);
+      for(int v : fwd)
+        slots.push_back(ord[v]);
+      std::sort(slots.begin(), slots.end());
+
+      for(i=0; i<bwd.size(); i++) {
+        ord[bwd[i]] = slots[i];
+        at[slots[i]-base] = bwd[i];
+      }
+      for(i=0; i<fwd.size(); i++) {
+        ord[fwd[i]] = slots[bwd.size()+i];
+        at[slots[bwd.size()+i]-base] = fwd[i];
+      }
+    }
+
+    // unmarks everything the searches marked (including vertices
+    //   left on the stack when a search stopped early)
+    void clear_marks() {
+      for(int v : fwd)
+        mark[v] = 0;
+      for(int v : bwd)
+        mark[v] = 0;
+      for(int v : stk)
+        mark[v] = 0;
+      fwd.clear();
+      bwd.clear();
+      stk.clear();
+    }
+
+    // the order from scratch, from g's current topological order
+    void build() {
+      vector<int> order;
+
+      ok = g.topo_sort(order);
+      if(g.is_frozen())
+        g.thaw();
+      base = 0;
+      at.clear();
+      ord.assign(g.num_nodes(), 0);
+      mark.assign(g.num_nodes(), 0);
+      for(int v : order) {
+        ord[v] = at.size();
+        at.push_back(v);
+      }
+      // removed vertices (isolated, and left out of the order) too
+      for(int v=0; v<g.num_nodes(); v++) {
+        if(g.is_removed(v)) {
+          ord[v] = at.size();
+          at.push_back(v);
+        }
+      }
+      record_state();
+    }
+
+    // records g's state as the one the order is valid for
+    void record_state() {
+      n = g.num_nodes();
+      m = g.num_edges();
+      relabels = g._relabels;
+    }
+
+    // builds the order again if g was changed behind our back
+    void refresh() {
+      if(n != g.num_nodes() || m != g.num_edges() || relabels != g._relabels)
+        build();
+    }
+
+  public:
+    /*
+     * builds the structure from g's current topological order.  If g
+     *   has a cycle, valid() is false and add_edge always fails.
+     */
+    dynamic_topo(graph &_g) : g { _g }, base { 0 } {
+      build();
+    }
+
+    bool valid() {
+      refresh();
+      return ok;
+    }
+
+    /*
+     * func:  add_edge
+     * desc:  adds edge (src,dest) to the graph and repairs the order.
+     *
+     *   returns false, leaving the graph unchanged, if the edge is
+     *   already in the graph or would create a cycle (a warning is
+     *   printed in either case).
+     */
+    bool add_edge(const string &src, const string &dest, double weight=1.0) {
+      int x, y;
+      bool acyclic = true;
+
+      refresh();
+      if(!ok)
+        return false;
+      // the searches need the per-vertex lists (and the duplicate
+      //   index), which freeze/compress/add_edges drop
+      if(g.is_frozen())
+        g.thaw();
+      if(src == dest) {
+        std::cerr << "warning: edge '" << src << " " << dest
+          << "' would create a cycle\n";
+        return false;
+      }
+
+      // (a removed vertex still has its position until the graph is
+      //   compacted, so it is looked up like any other)
+      x = g._names.find(src.data(), src.size());
+      y = g._names.find(dest.data(), dest.size());
+      if(x != -1 && y != -1) {
+        if(g.edges.contains(x, y))
+          return g.add_edge(src, dest, weight);   // prints the warning
+        if(ord[x] > ord[y]) {
+          acyclic = search_forward(y, ord[x]);
+          if(acyclic) {
+            search_backward(x, ord[y]);
+            reorder();
+          }
+          clear_marks();
+        }
+        if(!acyclic) {
+          std::cerr << "warning: edge '" << src << " " << dest
+            << "' would create a cycle\n";
+          return false;
+        }
+      }
+
+      g.add_edge(src, dest, weight);
+      if(x == -1)
+        place_front(g.name2id(src));
+      if(y == -1)
+        place_back(g.name2id(dest));
+      record_state();
+      return true;
+    }
+
+    /*
+     * func:  order
+     * desc:  the current topological order (vertex IDs, first to last).
+     */
+    void order(vector<int> &ids) {
+      refresh();
+      ids.assign(at.begin(), at.end());
+    }
+
+    /*
+     * func:  position
+     * desc:  position of vertex v in the current order (0 is first).
+     */
+    int position(int v) {
+      refresh();
+      return ord[v] - base;
+    }
+};
+
+
+
+
+/*
+ * class:  alt_index
+ *
+ * desc:   landmark distance tables for repeated point-to-point
+ *   shortest path queries on a graph that no longer changes ("ALT":
+ *   A*, landmarks and the triangle inequality; Goldberg and
+ *   Harrelson).
+ *
+ *   build(k) picks k landmarks and stores, for every vertex v and
+ *   every landmark L, d(L,v) and d(v,L).  By the triangle inequality,
+ *   for any target t
+ *
+ *       d(v,t) >= d(L,t) - d(L,v)    and    d(v,t) >= d(v,L) - d(t,L)
+ *
+ *   so the largest of these over all landmarks is a lower bound on
+ *   the distance left from v to t.  query() runs A* with that bound,
+ *   which steers the search towards the target instead of growing a
+ *   ball around the source like Dijkstra does.
+ *
+ *   Landmarks are picked "farthest first":  each new landmark is the
+ *   vertex farthest from the ones already picked (a vertex in another
+ *   component first).  Landmarks at the edge of the graph give the
+ *   tightest bounds.
+ *
+ *   The tables take 2*k*V doubles.  write saves them in a file next
+ *   to the graph and read memory maps them back (see
+ *   alt_file_header).  They are only valid for the graph they were
+ *   built for:  rebuild them after the graph changes (query and read
+ *   refuse tables whose vertex and edge counts don't match the
+ *   graph).
+ *
+ *   Usage:
+ *
+ *        graph g;
+ *        ...
+ *        alt_index alt(g);
+ *        if(!alt.read("roads.alt")) {
+ *          alt.build(16);
+ *          alt.write("roads.alt");
+ *        }
+ *        alt.query(src, dest, path, &length, &settled);
+ */
+class alt_index {
+
+  private:
+    graph &g;
+    int k;                    // number of landmarks; 0 if not built
+    uint64_t n, m;            // vertex and edge counts of g at build time
+    unsigned relabels;        // g._relabels at build time
+    flat_array<int> lm;       // landmark vertex IDs
+    flat_array<double> fwd;   // fwd[v*k + l]:  d(landmark l, v)
+    flat_array<double> bwd;   // bwd[v*k + l]:  d(v, landmark l)
+    std::shared_ptr<mapped_file> _mapping;
+
+    // query labels; valid only if seen[v] equals round (as in
+    //   graph::bidir_labels).  pot[v] is the lower bound on d(v, dest).
+    vector<unsigned> seen, done;
+    vector<double> dist, pot;
+    vector<int> pred;
+    unsigned round;
+
+    // rows of the query target in fwd and bwd
+    vector<double> tf, tb;
+
+    /*
+     * function:  sssp
+     * desc:  Dijkstra from src over outgoing edges (reverse == false)
+     *   or to src over incoming edges (reverse == true).  d[v] is set
+     *   to the distance, HUGE_VAL if there is no path.
+     */
+    void sssp(int src, bool reverse, vector<double> &d) {
+      const graph::csr &c = g.snapshot();
+      const flat_array<int> &off = reverse ? c.in_off : c.out_off;
+      const flat_array<int> &tgt = reverse ? c.in_tgt : c.out_tgt;
+      const flat_array<double> &wt = reverse ? c.in_wt : c.out_wt;
+      binary_heap pq;
+      int u, v, i;
+      double du;
+
+      d.assign(g.num_nodes(), HUGE_VAL);
+      pq.reset(g.num_nodes());
+      d[src] = 0;
+      pq.push(src, 0);
+      while(!pq.empty()) {
+        u = pq.pop(du);
+        for(i=off[u]; i<off[u+1]; i++) {
+          v = tgt[i];
+          if(du + wt[i] < d[v]) {
+            d[v] = du + wt[i];
+            pq.push(v, d[v]);
+          }
+        }
+      }
+    }
+
+    /*
+     * function:  bound
+     * desc:  lower bound on d(v, t) for the target whose rows are in
+     *   tf/tb.  HUGE_VAL means t is not reachable from v:  some
+     *   landmark reaches v but not t, or v reaches a landmark that t
+     *   does not.  inf - inf terms are NaN and drop out, since NaN > h
+     *   is false.
+     */
+    double bound(int v) const {
+      const double *f = fwd.data() + (size_t)v*k;
+      const double *b = bwd.data() + (size_t)v*k;
+      double h = 0;
+      int l;
+
+      for(l=0; l<k; l++) {
+        if(tf[l] - f[l] > h)
+          h = tf[l] - f[l];
+        if(b[l] - tb[l] > h)
+          h = b[l] - tb[l];
+      }
+      return h;
+    }
+
+    bool matches_graph() {
+      return k > 0 && n == (uint64_t)g.num_nodes() &&
+        m == (uint64_t)g.num_edges() && relabels == g._relabels;
+    }
+
+  public:
+    alt_index(graph &_g) : g { _g }, k { 0 }, n { 0 }, m { 0 },
+      relabels { 0 }, round { 0 } { }
+
+    int num_landmarks() const {
+      return k;
+    }
+
+    // vertex ID of landmark l (0 <= l < num_landmarks())
+    int landmark(int l) const {
+      return lm[l];
     }
 
     /*
-     *  TODO 30 points
-     *
-     *  func: dag_critical_paths
-     *  desc: for each vertex u, the length of the critical (LONGEST)
-     *        input-path ENDING AT u.
-     *
-     *        The "length" of a path is the SUM OF THE WEIGHTS OF THE
-     *        EDGES ON THE PATH.
+     * func:  build
+     * desc:  picks min(nlandmarks, V) landmarks and computes the
+     *   distance tables:  2 Dijkstra runs per landmark, O(k (V+E) log V).
      *
-     *        On completion, the results are stored in the vector rpt.
-     *        For each vertex u (as an intID),
+     * returns false (leaving the index empty) if nlandmarks < 1, the
+     *   graph is empty or some edge weight is negative.
+     */
+    bool build(int nlandmarks) {
+      vector<double> df, db, score;
+      int l, v, best, nv = g.num_nodes();
+      size_t i;
+
+      k = 0;
+      if(nlandmarks < 1 || nv == 0)
+        return false;
+      const graph::csr &c = g.snapshot();
+      for(i=0; i<c.out_wt.size(); i++) {
+        if(c.out_wt[i] < 0)
+          return false;
+      }
+
+      nlandmarks = std::min(nlandmarks, nv);
+      _mapping.reset();
+      lm.assign(nlandmarks, 0);
+      fwd.assign((size_t)nv*nlandmarks, 0);
+      bwd.assign((size_t)nv*nlandmarks, 0);
+
+      // score[v]:  distance (either way) from v to the nearest landmark
+      //   picked so far; -1 for the landmarks themselves.  Vertex 0
+      //   stands in for a landmark when picking the first one.
+      sssp(0, false, df);
+      sssp(0, true, db);
+      score.resize(nv);
+      for(v=0; v<nv; v++)
+        score[v] = std::min(df[v], db[v]);
+
+      for(l=0; l<nlandmarks; l++) {
+        best = 0;
+        for(v=1; v<nv; v++) {
+          if(score[v] > score[best])
+            best = v;
+        }
+        if(l == 0)
+          score.assign(nv, HUGE_VAL);
+        lm[l] = best;
+        score[best] = -1;
+
+        sssp(best, false, df);
+        sssp(best, true, db);
+        for(v=0; v<nv; v++) {
+          fwd[(size_t)v*nlandmarks + l] = df[v];
+          bwd[(size_t)v*nlandmarks + l] = db[v];
+          if(score[v] != -1)
+            score[v] = std::min(score[v], std::min(df[v], db[v]));
+        }
+      }
+      k = nlandmarks;
+      n = nv;
+      m = g.num_edges();
+      relabels = g._relabels;
+      return true;
+    }
+
+    /*
+     * func:  query
+     * desc:  shortest (minimum weight) path from src to dest by A*
+     *   with the landmark lower bounds.  The result is the same as
+     *   bidir_dijkstra's:  path holds the vertex IDs from src to dest;
+     *   if length is not NULL the path's length is stored there, and if
+     *   settled is not NULL the number of vertices the search settled.
      *
-     *          rpt[u].dist  stores the length of the longest (critical)
-     *            input-path ending at vertex u.
+     * returns false if the index is not built (or no longer matches
+     *   the graph), src or dest is out of range, or dest is not
+     *   reachable from src.
      *
-     *          rpt[u].pred  stores the predecessor vertex of u on a 
-     *            critical/longest input path ending at u.  If there
-     *            are multiple such paths (having equal maximum length)
-     *            there may be multiple correct predecessors.
+     * RUNTIME:  O(k) per vertex reached plus O(log) per queue
+     *   operation; typically settles a small fraction of what
+     *   Dijkstra would.
+     */
+    bool query(int src, int dest, vector<int> &path,
+        double *length=NULL, long long *settled=NULL) {
+      typedef std::pair<double, int> entry;
+      typedef std::priority_queue<entry, vector<entry>, std::greater<entry> > min_queue;
+      min_queue q;
+      int u, v, i, nv = g.num_nodes();
+      double nd;
+      long long nsettled = 0;
+      bool found = false;
+
+      path.clear();
+      if(settled != NULL)
+        *settled = 0;
+      if(!matches_graph() || src < 0 || src >= nv || dest < 0 || dest >= nv)
+        return false;
+
+      const graph::csr &c = g.snapshot();
+      if((int)seen.size() != nv || ++round == 0) {
+        seen.assign(nv, 0);
+        done.assign(nv, 0);
+        dist.resize(nv);
+        pot.resize(nv);
+        pred.resize(nv);
+        round = 1;
+      }
+      tf.assign(fwd.data() + (size_t)dest*k, fwd.data() + (size_t)(dest+1)*k);
+      tb.assign(bwd.data() + (size_t)dest*k, bwd.data() + (size_t)(dest+1)*k);
+
+      seen[src] = round;
+      dist[src] = 0;
+      pot[src] = bound(src);
+      pred[src] = src;
+      if(pot[src] != HUGE_VAL)
+        q.push(entry(pot[src], src));
+
+      while(!q.empty()) {
+        u = q.top().second;
+        q.pop();
+        // stale entry of a vertex whose distance has since dropped
+        if(done[u] == round)
+          continue;
+        done[u] = round;
+        nsettled++;
+        if(u == dest) {
+          found = true;
+          break;
+        }
+        for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+          v = c.out_tgt[i];
+          nd = dist[u] + c.out_wt[i];
+          if(seen[v] != round) {
+            seen[v] = round;
+            pot[v] = bound(v);
+          }
+          else if(nd >= dist[v])
+            continue;
+          // dest can't be reached through v
+          if(pot[v] == HUGE_VAL) {
+            dist[v] = HUGE_VAL;
+            continue;
+          }
+          dist[v] = nd;
+          pred[v] = u;
+          q.push(entry(nd + pot[v], v));
+        }
+      }
+      if(settled != NULL)
+        *settled = nsettled;
+      if(!found)
+        return false;
+      if(length != NULL)
+        *length = dist[dest];
+      for(u=dest; u!=src; u=pred[u])
+        path.push_back(u);
+      path.push_back(src);
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+
+    bool query(const string &src, const string &dest, vector<int> &path,
+        double *length=NULL, long long *settled=NULL) {
+      return query(g.name2id(src), g.name2id(dest), path, length, settled);
+    }
+
+    /*
+     * func:  write
+     * desc:  saves the landmarks and distance tables to file fname
+     *   (see alt_file_header).
      *
-     *  returns:  true on success (as long as graph is a DAG).
-     *            false if graph is not a DAG.
+     * returns true on success; false if the index is not built or the
+     *   file could not be written.
+     */
+    bool write(const string &fname) {
+      std::ofstream file;
+      alt_file_header h;
+      uint64_t pos;
+
+      if(k == 0)
+        return false;
+      file.open(fname, std::ios::out | std::ios::binary | std::ios::trunc);
+      if(!file.is_open())
+        return false;
+
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, ALT_FILE_MAGIC, sizeof(h.magic));
+      h.version = ALT_FILE_VERSION;
+      h.byte_order = GRAPH_FILE_BYTE_ORDER;
+      h.n = n;
+      h.m = m;
+      h.k = k;
+
+      // header is written twice, as in graph::write_binary
+      file.write((const char *)&h, sizeof(h));
+      pos = sizeof(h);
+      h.sec[0] = graph::write_section(file, pos, lm.data(), k*sizeof(int));
+      h.sec[1] = graph::write_section(file, pos, fwd.data(), n*k*sizeof(double));
+      h.sec[2] = graph::write_section(file, pos, bwd.data(), n*k*sizeof(double));
+
+      file.seekp(0);
+      file.write((const char *)&h, sizeof(h));
+      file.close();
+      return !file.fail();
+    }
+
+    /*
+     * func:  read
+     * desc:  loads tables saved by write.  The file is memory mapped
+     *   and the tables point directly into the mapping.
      *
-     *  runtime:  O(V+E)
+     * returns false (leaving the index as it was) if the file could
+     *   not be opened, is not a landmark file, or was built for a
+     *   graph with different vertex or edge counts.
      */
-    bool dag_critical_paths(vector<vertex_label> & rpt) {
+    bool read(const string &fname) {
+      std::shared_ptr<mapped_file> mf(new mapped_file);
+      const alt_file_header *h;
+      uint64_t sz[3];
+      int s;
 
-      if(has_cycle())
-      {
+      if(!mf->map(fname))
+        return false;
+
+      h = (const alt_file_header *)mf->base;
+      if(mf->size < sizeof(*h) ||
+          memcmp(h->magic, ALT_FILE_MAGIC, sizeof(h->magic)) != 0 ||
+          h->version != ALT_FILE_VERSION ||
+          h->byte_order != GRAPH_FILE_BYTE_ORDER ||
+          h->k == 0 || h->k >= (uint64_t)INT32_MAX) {
+        std::cerr << "error: '" << fname << "' is not a landmark file "
+          << "this program can read\n";
+        return false;
+      }
+      if(h->n != (uint64_t)g.num_nodes() || h->m != (uint64_t)g.num_edges()) {
+        std::cerr << "error: landmark file '" << fname << "' was built "
+          << "for a different graph\n";
+        return false;
+      }
+      h->section_sizes(sz);
+      for(s=0; s<3; s++) {
+        if(h->sec[s] % 8 != 0 || h->sec[s] > mf->size ||
+            sz[s] > mf->size - h->sec[s]) {
+          std::cerr << "error: landmark file '" << fname << "' is truncated\n";
           return false;
+        }
       }
-      std::vector<int> id_order;
-      topo_sort(id_order);
-      int u, v;
-      std::queue<int> q;
 
-      int src = id_order[0];
-      if (src < 0 || src >= num_nodes())
-      {
-          return false;
+      if(!valid_ids((const int *)(mf->base + h->sec[0]), h->k, 0, h->n)) {
+        std::cerr << "error: '" << fname << "' is not a landmark file "
+          << "this program can read\n";
+        return false;
       }
-          
 
-      init_report(rpt);
+      k = h->k;
+      n = h->n;
+      m = h->m;
+      relabels = g._relabels;
+      lm.view((const int *)(mf->base + h->sec[0]), k);
+      fwd.view((const double *)(mf->base + h->sec[1]), n*k);
+      bwd.view((const double *)(mf->base + h->sec[2]), n*k);
+      _mapping = mf;
+      return true;
+    }
+};
 
-      rpt[src].dist = 0;
 
-      rpt[src].pred = src;
-      rpt[src].npaths++;
-      rpt[src].state = DISCOVERED;
-      q.push(src);
-      int i;
-      for(i=1;i< id_order.size();i++)
-      {
-          src = id_order[i];
-          q.push(src);
 
-      }
-      while (!q.empty()) {
-          u = q.front();
-          q.pop();
+/*
+ * class:  ch_index
+ *
+ * desc:   contraction hierarchy (Geisberger et al.) of a graph that no
+ *   longer changes, for very fast point-to-point shortest path
+ *   queries.
+ *
+ *   Preprocessing (build) contracts the vertices one at a time in
+ *   order of "importance":  contracting v removes it from the graph
+ *   and, for each pair of neighbors u -> v -> w, adds a shortcut arc
+ *   u -> w of weight d(u,v) + d(v,w) unless a local "witness" search
+ *   finds a path from u to w at least as short that avoids v.  The
+ *   order in which v is contracted is its rank.  Vertices that need
+ *   few shortcuts go first; the priority of v is
+ *
+ *       2 * ((shortcuts needed) - (arcs removed))
+ *         + (neighbors contracted) + level
+ *
+ *   where level is 1 + the highest level of a contracted neighbor.
+ *   The last two terms spread contraction evenly over the graph, which
+ *   keeps the hierarchy shallow.
+ *
+ *   The hierarchy is stored as two CSR graphs of original edges and
+ *   shortcuts:
+ *
+ *     up:  for each v, the arcs v -> w with rank[w] > rank[v]
+ *     dn:  for each v, the arcs u -> v with rank[u] > rank[v]
+ *          (stored at v; tgt is u)
+ *
+ *   For every pair of vertices there is a shortest path in the
+ *   hierarchy that only goes up and then only down.  So query runs
+ *   Dijkstra forward from src over up and backward from dest over dn
+ *   -- both only climbing, which keeps them tiny -- and takes the best
+ *   vertex where they meet.  A shortcut remembers the vertex it skips
+ *   (mid; -1 for an original edge), so the path can be unpacked into
+ *   original vertex IDs.
+ *
+ *   Preprocessing is parallel:  each round contracts an independent
+ *   set of vertices (each with lower priority than all its remaining
+ *   neighbors) at once, with the witness searches and priority
+ *   updates running on the graph's worker threads.
+ *
+ *   write saves the hierarchy next to the graph and read memory maps
+ *   it back (see ch_file_header).  As with alt_index it is only valid
+ *   for the graph it was built for.
+ *
+ *   Usage:
+ *
+ *        graph g;
+ *        g.read_file("roads.txt");
+ *        ch_index ch(g);
+ *        if(!ch.read("roads.ch")) {
+ *          ch.build();
+ *          ch.write("roads.ch");
+ *        }
+ *        ch.query(src, dest, path, &length);
+ */
+class ch_index {
 
-          if(vertices[u].incoming.size() == 0)
-          {
-              rpt[u].dist = 0;
-              rpt[u].pred = u;
-              rpt[u].npaths++;
-              rpt[u].state = DISCOVERED;
+  private:
+    // arc of the graph being contracted:  to v (in out lists) or from
+    //   v (in in lists).  mid is the vertex a shortcut skips; -1 for
+    //   an original edge.
+    struct arc {
+      int v;
+      double w;
+      int mid;
+    };
+
+    struct shortcut {
+      int u, w;
+      double wt;
+      int mid;
+    };
+
+    // per-thread work space of build:  witness search labels and
+    //   queue (labels are valid only if seen[x] / target[x] equal
+    //   round, as in graph::bidir_labels) and the thread's share of a
+    //   round's results
+    struct witness_space {
+      vector<unsigned> seen, target;
+      vector<double> dist;
+      vector<std::pair<double, int> > heap;
+      unsigned round = 0;
+      vector<int> picked;
+      vector<shortcut> found;
+    };
+
+    // a witness search gives up after settling this many vertices; a
+    //   search cut short can only add unneeded shortcuts, never lose
+    //   a path
+    static const int WITNESS_LIMIT = 500;
+
+    graph &g;
+    uint64_t n, m;            // vertex and edge counts of g at build
+                              //   time; n is 0 if not built
+    unsigned relabels;        // g._relabels at build time
+    flat_array<int> rank;
+    flat_array<int> up_off, up_tgt, up_mid;
+    flat_array<double> up_wt;
+    flat_array<int> dn_off, dn_tgt, dn_mid;
+    flat_array<double> dn_wt;
+    std::shared_ptr<mapped_file> _mapping;
+
+    // the graph being contracted (only during build)
+    vector<vector<arc> > out, in;
+    vector<char> state;       // 0: not contracted, 1: being contracted
+                              //   this round, 2: contracted
+    vector<double> prio;
+    vector<int> ncontracted;  // number of contracted neighbors
+    vector<int> level;        // 1 + the highest level of a contracted
+                              //   neighbor (0 if none)
+
+    // query labels:  side 0 searches up from src, side 1 from dest
+    graph::bidir_labels lab;
+
+    // adds arc (v, w, mid) to list, or lowers the weight of the arc
+    //   to v already there
+    static void add_arc(vector<arc> &list, int v, double w, int mid) {
+      for(arc &a : list) {
+        if(a.v == v) {
+          if(w < a.w) {
+            a.w = w;
+            a.mid = mid;
           }
-          
-          for (edge& e : vertices[u].outgoing) {
-              v = e.vertex_id;
-              if (rpt[v].dist < rpt[u].dist + e.weight)
-              {
-                  rpt[v].npaths = rpt[u].npaths + rpt[v].npaths;
-                  rpt[v].dist = rpt[u].dist + e.weight;
-                  rpt[v].pred = u;
-                  rpt[v].state = DISCOVERED;
-              }
-                      
+          return;
+        }
+      }
+      list.push_back(arc { v, w, mid });
+    }
+
+    static void remove_arc(vector<arc> &list, int v) {
+      size_t i;
+
+      for(i=0; i<list.size(); i++) {
+        if(list[i].v == v) {
+          list[i] = list.back();
+          list.pop_back();
+          return;
+        }
+      }
+    }
+
+    /*
+     * function:  witness
+     * desc:  Dijkstra from u over vertices that are not contracted
+     *   (state 0) other than v, until it has settled all of v's other
+     *   out-neighbors, the queue minimum exceeds maxd, or WITNESS_LIMIT
+     *   vertices are settled.  Afterwards ws.dist[x] is an upper bound
+     *   on d(u,x) (avoiding v) for each x reached.
+     */
+    void witness(int u, int v, double maxd, witness_space &ws) {
+      std::greater<std::pair<double, int> > cmp;
+      int x, nsettled = 0, left = 0;
+      double dx;
+
+      if(ws.seen.size() != out.size() || ++ws.round == 0) {
+        ws.seen.assign(out.size(), 0);
+        ws.target.assign(out.size(), 0);
+        ws.dist.resize(out.size());
+        ws.round = 1;
+      }
+      for(const arc &b : out[v]) {
+        if(state[b.v] == 0 && b.v != u && ws.target[b.v] != ws.round) {
+          ws.target[b.v] = ws.round;
+          left++;
+        }
+      }
+
+      ws.heap.clear();
+      ws.seen[u] = ws.round;
+      ws.dist[u] = 0;
+      ws.heap.push_back(std::make_pair(0.0, u));
+      while(!ws.heap.empty() && left > 0 && nsettled < WITNESS_LIMIT) {
+        std::pop_heap(ws.heap.begin(), ws.heap.end(), cmp);
+        dx = ws.heap.back().first;
+        x = ws.heap.back().second;
+        ws.heap.pop_back();
+        if(dx > ws.dist[x])
+          continue;
+        if(dx > maxd)
+          break;
+        nsettled++;
+        if(ws.target[x] == ws.round)
+          left--;
+        for(const arc &a : out[x]) {
+          if(state[a.v] != 0 || a.v == v)
+            continue;
+          if(ws.seen[a.v] != ws.round || dx + a.w < ws.dist[a.v]) {
+            ws.seen[a.v] = ws.round;
+            ws.dist[a.v] = dx + a.w;
+            ws.heap.push_back(std::make_pair(dx + a.w, a.v));
+            std::push_heap(ws.heap.begin(), ws.heap.end(), cmp);
           }
-          
+        }
       }
-     
-      return true;
     }
 
     /*
-     *  TODO 30 points
-     *  function:  dag_num_paths
-     *  desc:  if given graph (calling object) is a DAG, the vector
-     *         rpt is populated such that:
-     *
-     *           rpt[u].npaths = number of io-paths passing through
-     *                            vertex u.
-     *
-     *           Recall: an IO path starts at an input vertex and
-     *             ends at an output vertex.
-     *
-     *           This value is defined for all vertices u in the
-     *             graph (inputs, outputs and "intermediate" nodes).
-     *
-     *  NOTES:  rpt[u].pred, and rpt[u].dist have no partiular 
-     *          meaning after this operation.
-     *
-     *  EXAMPLE:
+     * function:  shortcuts
+     * desc:  the number of shortcuts contracting v needs now; if
+     *   record is true they are also appended to ws.found.
+     */
+    int shortcuts(int v, witness_space &ws, bool record) {
+      double maxout = 0;
+      int count = 0;
+
+      for(const arc &b : out[v])
+        maxout = std::max(maxout, b.w);
+      for(const arc &a : in[v]) {
+        if(state[a.v] != 0)
+          continue;
+        witness(a.v, v, a.w + maxout, ws);
+        for(const arc &b : out[v]) {
+          if(state[b.v] != 0 || b.v == a.v)
+            continue;
+          if(ws.seen[b.v] == ws.round && ws.dist[b.v] <= a.w + b.w)
+            continue;
+          count++;
+          if(record)
+            ws.found.push_back(shortcut { a.v, b.v, a.w + b.w, v });
+        }
+      }
+      return count;
+    }
 
-                         a  b  c
-                         \  |  /
-                          \ | /
-                            d
-                           / \
-                          e   f
-                           \ /
-                            g
-                           / \
-                          h   i
-                           \ /
-                            j
+    double priority(int v, witness_space &ws) {
+      double diff = shortcuts(v, ws, false) - (double)(in[v].size() + out[v].size());
+      return 2*diff + ncontracted[v] + level[v];
+    }
 
-            There are 3 input nodes (a,b,c) and one output node (j)
-            in this graph.
+    // true if v comes before all of its neighbors (priority, then ID)
+    bool local_min(int v) const {
+      for(const arc &a : out[v]) {
+        if(prio[a.v] < prio[v] || (prio[a.v] == prio[v] && a.v < v))
+          return false;
+      }
+      for(const arc &a : in[v]) {
+        if(prio[a.v] < prio[v] || (prio[a.v] == prio[v] && a.v < v))
+          return false;
+      }
+      return true;
+    }
 
-            There are 12 distinct io-paths passing through vertex d in 
-            this dag (note:  edges are pointed downward)
+    // packs the per-vertex arc lists into off/tgt/wt/mid
+    static void pack(const vector<vector<arc> > &lists, flat_array<int> &off,
+        flat_array<int> &tgt, flat_array<double> &wt, flat_array<int> &mid) {
+      size_t u, i;
+
+      off.assign(lists.size()+1, 0);
+      for(u=0; u<lists.size(); u++)
+        off[u+1] = off[u] + lists[u].size();
+      tgt.assign(off[lists.size()], 0);
+      wt.assign(off[lists.size()], 0);
+      mid.assign(off[lists.size()], 0);
+      for(u=0; u<lists.size(); u++) {
+        i = off[u];
+        for(const arc &a : lists[u]) {
+          tgt[i] = a.v;
+          wt[i] = a.w;
+          mid[i++] = a.mid;
+        }
+      }
+    }
 
-            Can you enumerate them?
+    // mid of the hierarchy arc a -> b:  in up at a if b ranks higher,
+    //   otherwise in dn at b
+    int arc_mid(int a, int b) const {
+      int i;
 
+      for(i=up_off[a]; i<up_off[a+1]; i++) {
+        if(up_tgt[i] == b)
+          return up_mid[i];
+      }
+      for(i=dn_off[b]; i<dn_off[b+1]; i++) {
+        if(dn_tgt[i] == a)
+          return dn_mid[i];
+      }
+      return -1;
+    }
+
+    bool matches_graph() {
+      return n > 0 && n == (uint64_t)g.num_nodes() &&
+        m == (uint64_t)g.num_edges() && relabels == g._relabels;
+    }
+
+  public:
+    ch_index(graph &_g) : g { _g }, n { 0 }, m { 0 }, relabels { 0 } { }
+
+    // number of arcs (original edges and shortcuts) in the hierarchy
+    size_t num_arcs() const {
+      return up_tgt.size() + dn_tgt.size();
+    }
+
+    // contraction order of vertex v (0 is contracted first)
+    int vertex_rank(int v) const {
+      return rank[v];
+    }
+
+    /*
+     * func:  build
+     * desc:  contracts the graph into a hierarchy using nthreads
+     *   threads (nthreads <= 0 means one per hardware thread).
      *
-     *  returns true if graph is a DAG; false otherwise.        
-     *
-     *  RUNTIME:  O(V+E)  -- Note: in general, the number of paths
-     *                       in a graph may be exponential in the
-     *                       number of vertices.
-     *
-     *                       This means that you cannot explicitly
-     *                       enumerate all of the paths and count them!
-     *                       (The enum_paths function below which DOES
-     *                       enumerate a set of paths MAY take exponential
-     *                       time).
-     *
-     * General Hint:  an io-path passing through a vertex u is 
-     *   composed of an input-path ending at u, followed by an
-     *   output path starting at u.  
+     * returns false (leaving the index empty) if the graph is empty
+     *   or some edge weight is negative.
+     */
+    bool build(int nthreads=0) {
+      vector<vector<arc> > up, dn;
+      vector<int> remaining, picked, touched;
+      vector<char> mark;
+      int u, v, i, nv = g.num_nodes(), next = 0;
+      size_t t;
+
+      n = 0;
+      if(nv == 0)
+        return false;
+      const graph::csr &c = g.snapshot();
+      for(i=0; i<(int)c.out_wt.size(); i++) {
+        if(c.out_wt[i] < 0)
+          return false;
+      }
+      worker_pool &wp = g.pool(nthreads);
+      vector<witness_space> ws(wp.size());
+
+      // self-loops are never on a shortest path
+      out.assign(nv, vector<arc>());
+      in.assign(nv, vector<arc>());
+      for(u=0; u<nv; u++) {
+        for(i=c.out_off[u]; i<c.out_off[u+1]; i++) {
+          if(c.out_tgt[i] != u) {
+            out[u].push_back(arc { c.out_tgt[i], c.out_wt[i], -1 });
+            in[c.out_tgt[i]].push_back(arc { u, c.out_wt[i], -1 });
+          }
+        }
+      }
+      state.assign(nv, 0);
+      ncontracted.assign(nv, 0);
+      level.assign(nv, 0);
+      prio.assign(nv, 0);
+      mark.assign(nv, 0);
+      rank.assign(nv, 0);
+      up.resize(nv);
+      dn.resize(nv);
+
+      wp.for_blocks(nv, [&](size_t lo, size_t hi, int tid) {
+        for(size_t x=lo; x<hi; x++)
+          prio[x] = priority(x, ws[tid]);
+      }, 64);
+      for(u=0; u<nv; u++)
+        remaining.push_back(u);
+
+      while(!remaining.empty()) {
+        // the round's independent set
+        for(t=0; t<ws.size(); t++)
+          ws[t].picked.clear();
+        wp.for_blocks(remaining.size(), [&](size_t lo, size_t hi, int tid) {
+          for(size_t j=lo; j<hi; j++) {
+            if(local_min(remaining[j]))
+              ws[tid].picked.push_back(remaining[j]);
+          }
+        }, 256);
+        picked.clear();
+        for(t=0; t<ws.size(); t++)
+          picked.insert(picked.end(), ws[t].picked.begin(), ws[t].picked.end());
+        for(int x : picked)
+          state[x] = 1;
+
+        // witness searches avoid all of the round's vertices, so the
+        //   shortcuts of one don't count on paths through another
+        wp.for_blocks(picked.size(), [&](size_t lo, size_t hi, int tid) {
+          for(size_t j=lo; j<hi; j++)
+            shortcuts(picked[j], ws[tid], true);
+        }, 8);
+
+        for(int x : picked) {
+          rank[x] = next++;
+          state[x] = 2;
+          up[x].swap(out[x]);
+          dn[x].swap(in[x]);
+          vector<arc>().swap(out[x]);
+          vector<arc>().swap(in[x]);
+          for(const arc &a : up[x]) {
+            remove_arc(in[a.v], x);
+            ncontracted[a.v]++;
+            level[a.v] = std::max(level[a.v], level[x] + 1);
+            if(!mark[a.v]) {
+              mark[a.v] = 1;
+              touched.push_back(a.v);
+            }
+          }
+          for(const arc &a : dn[x]) {
+            remove_arc(out[a.v], x);
+            ncontracted[a.v]++;
+            level[a.v] = std::max(level[a.v], level[x] + 1);
+            if(!mark[a.v]) {
+              mark[a.v] = 1;
+              touched.push_back(a.v);
+            }
+          }
+        }
+        for(t=0; t<ws.size(); t++) {
+          for(const shortcut &sc : ws[t].found) {
+            add_arc(out[sc.u], sc.w, sc.wt, sc.mid);
+            add_arc(in[sc.w], sc.u, sc.wt, sc.mid);
+          }
+          ws[t].found.clear();
+        }
+
+        wp.for_blocks(touched.size(), [&](size_t lo, size_t hi, int tid) {
+          for(size_t j=lo; j<hi; j++)
+            prio[touched[j]] = priority(touched[j], ws[tid]);
+        }, 64);
+        for(int x : touched)
+          mark[x] = 0;
+        touched.clear();
+
+        for(i=v=0; i<(int)remaining.size(); i++) {
+          if(state[remaining[i]] == 0)
+            remaining[v++] = remaining[i];
+        }
+        remaining.resize(v);
+      }
+
+      pack(up, up_off, up_tgt, up_wt, up_mid);
+      pack(dn, dn_off, dn_tgt, dn_wt, dn_mid);
+      vector<vector<arc> >().swap(out);
+      vector<vector<arc> >().swap(in);
+      vector<char>().swap(state);
+      vector<double>().swap(prio);
+      vector<int>().swap(ncontracted);
+      vector<int>().swap(level);
+      _mapping.reset();
+      n = nv;
+      m = g.num_edges();
+      relabels = g._relabels;
+      return true;
+    }
+
+    /*
+     * func:  query
+     * desc:  shortest (minimum weight) path from src to dest in the
+     *   hierarchy, unpacked into original vertex IDs.  The results are
+     *   as for bidir_dijkstra:  path from src to dest; if length is not
+     *   NULL the path's length, and if settled is not NULL the number
+     *   of vertices the two searches settled.
      *
-     *   Now, if you could figure out the number of input-paths
-     *   ending at u and the number of output paths starting at u, 
-     *   could you determine the number of io-paths passing through
-     *   u?
+     *   Each search stops once its queue minimum reaches mu, the best
+     *   src-dest distance found so far.
      *
+     * returns false if the hierarchy is not built (or no longer
+     *   matches the graph), src or dest is out of range, or dest is
+     *   not reachable from src.
      */
-    bool dag_num_paths(vector<vertex_label>& rpt) 
-    {
-        if (has_cycle())
-        {
-            return false;
-        }
+    bool query(int src, int dest, vector<int> &path,
+        double *length=NULL, long long *settled=NULL) {
+      typedef std::pair<double, int> entry;
+      typedef std::priority_queue<entry, vector<entry>, std::greater<entry> > min_queue;
+      min_queue q[2];
+      vector<int> hpath;
+      vector<std::pair<int, int> > stk;
+      int s, u, v, i, a, b, mid, meet = -1, nv = g.num_nodes();
+      double du, nd, mu = HUGE_VAL;
+      long long nsettled = 0;
 
-        std::vector<int> id_order;
-        std::vector<int> InPaths(num_nodes(), 0);
-        std::vector<int> OutPaths(num_nodes(), 0);
-        topo_sort(id_order);
+      path.clear();
+      if(settled != NULL)
+        *settled = 0;
+      if(!matches_graph() || src < 0 || src >= nv || dest < 0 || dest >= nv)
+        return false;
 
-        int u, v;
-        int src = id_order[0];
+      lab.start(nv);
+      lab.reach(0, src, 0, src);
+      lab.reach(1, dest, 0, dest);
+      q[0].push(entry(0, src));
+      q[1].push(entry(0, dest));
 
-        if (src < 0 || src >= num_nodes())
-        {
-            return false;
+      while(true) {
+        for(s=0; s<2; s++) {
+          if(!q[s].empty() && q[s].top().first >= mu)
+            q[s] = min_queue();
         }
-       
-        init_report(rpt);
-      
-
-        for (int i = InPaths.size() - 1; i >= 0; i--)
-        {
-            u = id_order[i];
-            if (vertices[u].outgoing.size() == 0)
-            {
-                InPaths[u] = 1;
-            }
-            for (edge& e : vertices[u].incoming)
-            {
-                v = e.vertex_id;
-                InPaths[v] += InPaths[u];
-            }
+        if(q[0].empty() && q[1].empty())
+          break;
+        s = q[1].empty() ||
+          (!q[0].empty() && q[0].top().first <= q[1].top().first) ? 0 : 1;
+        du = q[s].top().first;
+        u = q[s].top().second;
+        q[s].pop();
+        if(lab.settled(s, u) || du > lab.dist[s][u])
+          continue;
+        lab.done[s][u] = lab.round;
+        nsettled++;
+        if(lab.reached(1-s, u) && du + lab.dist[1-s][u] < mu) {
+          mu = du + lab.dist[1-s][u];
+          meet = u;
         }
 
-
-        for (int i = 0; i < OutPaths.size(); i++)
-        {
-            u = id_order[i];
-            if (vertices[u].incoming.size() == 0)
-            {
-                OutPaths[u] = 1;
-            }
-            for (edge& e : vertices[u].outgoing)
-            {
-                v = e.vertex_id;
-                OutPaths[v] += OutPaths[u];
-                
-            }
+        const flat_array<int> &off = s == 0 ? up_off : dn_off;
+        const flat_array<int> &tgt = s == 0 ? up_tgt : dn_tgt;
+        const flat_array<double> &wt = s == 0 ? up_wt : dn_wt;
+        for(i=off[u]; i<off[u+1]; i++) {
+          v = tgt[i];
+          nd = du + wt[i];
+          if(!lab.reached(s, v) || nd < lab.dist[s][v]) {
+            lab.reach(s, v, nd, u);
+            q[s].push(entry(nd, v));
+          }
         }
+      }
+      if(settled != NULL)
+        *settled = nsettled;
+      if(meet == -1)
+        return false;
+      if(length != NULL)
+        *length = mu;
+
+      // path in the hierarchy:  up from src to meet, down to dest
+      for(u=meet; lab.pred[0][u] != u; u=lab.pred[0][u])
+        hpath.push_back(u);
+      hpath.push_back(u);
+      std::reverse(hpath.begin(), hpath.end());
+      for(u=meet; lab.pred[1][u] != u; ) {
+        u = lab.pred[1][u];
+        hpath.push_back(u);
+      }
 
-        for (int i = 0; i < id_order.size(); i++)
-        {
-            u = id_order[i];
-            rpt[u].npaths = OutPaths[u] * InPaths[u];
+      // unpack each arc, replacing a shortcut a -> b that skips mid by
+      //   a -> mid and mid -> b until only original edges are left
+      path.push_back(src);
+      for(i=0; i+1<(int)hpath.size(); i++) {
+        stk.push_back(std::make_pair(hpath[i], hpath[i+1]));
+        while(!stk.empty()) {
+          a = stk.back().first;
+          b = stk.back().second;
+          stk.pop_back();
+          mid = arc_mid(a, b);
+          if(mid == -1)
+            path.push_back(b);
+          else {
+            stk.push_back(std::make_pair(mid, b));
+            stk.push_back(std::make_pair(a, mid));
+          }
         }
- 
+      }
       return true;
     }
 
+    bool query(const string &src, const string &dest, vector<int> &path,
+        double *length=NULL, long long *settled=NULL) {
+      return query(g.name2id(src), g.name2id(dest), path, length, settled);
+    }
+
     /*
-     * TODO 20 points
-     * function:  valid_topo_order
-     * desc:  determines if vertex sequence in the given vector
-     *        (parameter order) is a valid topological ordering of
-     *        the given graph (calling object).
-     *
-     *        returns true if it is; false otherwise.
-     *
-     * details:  returns false if graph is not a DAG.
+     * func:  write
+     * desc:  saves the hierarchy to file fname (see ch_file_header).
      *
-     *           Note that vertices are given as their integer IDs.
+     * returns true on success; false if the hierarchy is not built or
+     *   the file could not be written.
+     */
+    bool write(const string &fname) {
+      std::ofstream file;
+      ch_file_header h;
+      uint64_t pos;
+
+      if(n == 0)
+        return false;
+      file.open(fname, std::ios::out | std::ios::binary | std::ios::trunc);
+      if(!file.is_open())
+        return false;
+
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, CH_FILE_MAGIC, sizeof(h.magic));
+      h.version = CH_FILE_VERSION;
+      h.byte_order = GRAPH_FILE_BYTE_ORDER;
+      h.n = n;
+      h.m = m;
+      h.mu = up_tgt.size();
+      h.md = dn_tgt.size();
+
+      // header is written twice, as in graph::write_binary
+      file.write((const char *)&h, sizeof(h));
+      pos = sizeof(h);
+      h.sec[0] = graph::write_section(file, pos, rank.data(), n*sizeof(int));
+      h.sec[1] = graph::write_section(file, pos, up_off.data(), (n+1)*sizeof(int));
+      h.sec[2] = graph::write_section(file, pos, up_tgt.data(), h.mu*sizeof(int));
+      h.sec[3] = graph::write_section(file, pos, up_wt.data(), h.mu*sizeof(double));
+      h.sec[4] = graph::write_section(file, pos, up_mid.data(), h.mu*sizeof(int));
+      h.sec[5] = graph::write_section(file, pos, dn_off.data(), (n+1)*sizeof(int));
+      h.sec[6] = graph::write_section(file, pos, dn_tgt.data(), h.md*sizeof(int));
+      h.sec[7] = graph::write_section(file, pos, dn_wt.data(), h.md*sizeof(double));
+      h.sec[8] = graph::write_section(file, pos, dn_mid.data(), h.md*sizeof(int));
+
+      file.seekp(0);
+      file.write((const char *)&h, sizeof(h));
+      file.close();
+      return !file.fail();
+    }
+
+    /*
+     * func:  read
+     * desc:  loads a hierarchy saved by write.  The file is memory
+     *   mapped and the arrays point directly into the mapping.
      *
-     * RUNTIME:  O(V+E)
+     * returns false (leaving the index as it was) if the file could
+     *   not be opened, is not a hierarchy file, or was built for a
+     *   graph with different vertex or edge counts.
      */
-    bool valid_topo_order(const vector<int> & order) {
-      if(has_cycle())
-      {
+    bool read(const string &fname) {
+      std::shared_ptr<mapped_file> mf(new mapped_file);
+      const ch_file_header *h;
+      uint64_t sz[9];
+      int s;
+
+      if(!mf->map(fname))
+        return false;
+
+      h = (const ch_file_header *)mf->base;
+      if(mf->size < sizeof(*h) ||
+          memcmp(h->magic, CH_FILE_MAGIC, sizeof(h->magic)) != 0 ||
+          h->version != CH_FILE_VERSION ||
+          h->byte_order != GRAPH_FILE_BYTE_ORDER ||
+          h->mu >= (uint64_t)INT32_MAX || h->md >= (uint64_t)INT32_MAX) {
+        std::cerr << "error: '" << fname << "' is not a hierarchy file "
+          << "this program can read\n";
+        return false;
+      }
+      if(h->n == 0 || h->n != (uint64_t)g.num_nodes() ||
+          h->m != (uint64_t)g.num_edges()) {
+        std::cerr << "error: hierarchy file '" << fname << "' was built "
+          << "for a different graph\n";
+        return false;
+      }
+      h->section_sizes(sz);
+      for(s=0; s<9; s++) {
+        if(h->sec[s] % 8 != 0 || h->sec[s] > mf->size ||
+            sz[s] > mf->size - h->sec[s]) {
+          std::cerr << "error: hierarchy file '" << fname << "' is truncated\n";
           return false;
+        }
+      }
+
+      // ranks and arc targets are vertices; mids are vertices or -1
+      if(!valid_ids((const int *)(mf->base + h->sec[0]), h->n, 0, h->n) ||
+          !valid_csr((const int *)(mf->base + h->sec[1]),
+            (const int *)(mf->base + h->sec[2]), h->n, h->mu) ||
+          !valid_ids((const int *)(mf->base + h->sec[4]), h->mu, -1, h->n) ||
+          !valid_csr((const int *)(mf->base + h->sec[5]),
+            (const int *)(mf->base + h->sec[6]), h->n, h->md) ||
+          !valid_ids((const int *)(mf->base + h->sec[8]), h->md, -1, h->n)) {
+        std::cerr << "error: '" << fname << "' is not a hierarchy file "
+          << "this program can read\n";
+        return false;
       }
-      std::vector<bool> Visited(num_nodes(), false);
-      int u, v;
-       
-       for(int i = 0; i<order.size();i++)
-       {
-           u = order[i];
-           if(vertices[u].incoming.size()==0)
-           {
-               Visited[u] = true;
-           }
-           else
-           {
-               for(int j = 0; j< vertices[u].incoming.size(); j++)
-               {
-                   v = vertices[u].incoming[j].vertex_id;
-                   if(Visited[v] == false)
-                   {
-                       return false;
-                   }
-               }
-              Visited[u] = true;
-           }
-       }
-      return true;
 
+      n = h->n;
+      m = h->m;
+      relabels = g._relabels;
+      rank.view((const int *)(mf->base + h->sec[0]), n);
+      up_off.view((const int *)(mf->base + h->sec[1]), n+1);
+      up_tgt.view((const int *)(mf->base + h->sec[2]), h->mu);
+      up_wt.view((const double *)(mf->base + h->sec[3]), h->mu);
+      up_mid.view((const int *)(mf->base + h->sec[4]), h->mu);
+      dn_off.view((const int *)(mf->base + h->sec[5]), n+1);
+      dn_tgt.view((const int *)(mf->base + h->sec[6]), h->md);
+      dn_wt.view((const double *)(mf->base + h->sec[7]), h->md);
+      dn_mid.view((const int *)(mf->base + h->sec[8]), h->md);
+      _mapping = mf;
+      return true;
     }
+};
 
-    /*
-     * TODO 30 points
-     *
-     * function:  enum_paths
-     * desc:  enumerates all input-paths ending at target vertes in
-     *        a DAG.
-     * details:  Given a DAG and vertex target in the graph, the
-     *   vector paths is populated with ALL input paths ending at
-     *   vertex target.
-     *
-     * [NOTE:  target vertex is passed as its integer ID; however,
-     *   vertices in paths constructed are represented by their 
-     *   name -- as a string]
-     *
-     * A path is represented as a string containing the names of
-     * each vertex (NOT intger vertex IDs) on the path in sequence; 
-     * vertex names are separated by a single space.
-     *
-     * returns:  true on success; 
-     *           false on failure (graph is not a DAG or target vertex ID
-     *           is out of range).
-     *
-     * RUNTIME:  this one may be unavoidably exponential!
-     *
-     * EXAMPLES:
-     *
-     *   Chicago
-     *   NewYork
-     *   LosAngeles
-     *
-     * and there are edges:
-     *
-     *   LosAngeles Chicago
-     *   Chicago NewYork
-     *
-     * The path LosAngeles to Chicago to NewYork is represented by the
-     * string:
-     *
-     *   "LosAngeles Chicago NewYork"
-     *
-     * Another example:  the input file ex1A is a DAG.  Using vertex g
-     * as the target (integer ID: 6), will result in the paths vector
-     * containing the following strings:
-     *
 
-           "a d g"
-           "a b d g"
-           "a c d g"
-           "a d e g"
-           "a b d e g"
-           "a c d e g"
-           "a d f g"
-           "a b d f g"
-           "a c d f g"
-     *
-     * NOTE:  the concatenation operator '+' on strings might
-     *   make some of your work pretty easy to code!
-     *
-     * COMMENT:  this function can be implemented with about
-     *   20 lines of code.
-     */
-    bool enum_paths(int target, vector<string> &paths) {
-      paths.clear();
-      if(has_cycle() || target < 0 || target >= num_nodes())
-      {
+
+/*
+ * class:  reach_index
+ *
+ * desc:   answers "can u reach v?" for a graph that changes rarely,
+ *   usually without searching the graph.
+ *
+ *   The index is built over the condensation (see graph::condensation):
+ *   u reaches v iff they are in the same component or u's component
+ *   reaches v's in the component DAG.  Two cheap necessary conditions
+ *   for component a to reach component b rule out most pairs:
+ *
+ *     ord[a] < ord[b]:  ord is a topological order of the components.
+ *
+ *     interval labels (GRAIL; Yildirim, Chaoji and Zaki):  a DFS of
+ *       the DAG (children in random order) numbers the components in
+ *       post-order, and gives component a the interval
+ *       [lowest number among a and its descendants, number of a].
+ *       Anything a reaches has its interval inside a's.  The index
+ *       keeps k such labelings from different random DFSs; a must
+ *       contain b in all of them.
+ *
+ *   The first labeling also gives a sufficient condition:  the
+ *   components below a in its DFS tree have the post-order numbers
+ *   [number of the first one finished, number of a], so if b's number
+ *   is in that range a reaches b.
+ *
+ *   Only if none of this settles it does can_reach search, with a DFS
+ *   from a that skips every component failing the necessary tests
+ *   for b.
+ *
+ *   Edges added through the index (add_edge) update it in place when
+ *   they don't break the topological order:  the new edge's target's
+ *   intervals are merged into those of its source and the source's
+ *   ancestors, which keeps every condition necessary.  Otherwise --
+ *   or if the graph was changed behind the index's back -- the index
+ *   is rebuilt, at the latest by the next query.
+ *
+ *   Usage:
+ *
+ *        graph g;
+ *        ...
+ *        reach_index ri(g);
+ *        ri.add_edge("app", "libfoo");
+ *        if(ri.can_reach("app", "libc")) ...
+ */
+class reach_index {
+
+  public:
+    struct reach_stats {
+      int components;         // vertices of the component DAG
+      long long dag_edges;
+      size_t bytes;           // memory used by the index
+      double build_ms;        // time of the last full build
+      int builds;             // number of full builds
+      long long incremental;  // edges added without a rebuild
+      long long queries;
+      long long searches;     // queries the labels could not answer
+    };
+
+  private:
+    graph &g;
+    int k;                          // number of interval labelings
+    int n, m;                       // vertex and edge counts of g that
+                                    //   the index reflects
+    unsigned relabels;              // g._relabels when last built
+    vector<int> comp;               // comp[u]:  component of vertex u
+    vector<vector<int> > succ, pred;  // component DAG
+    vector<int> ord;                // topological position of a component
+    int ord_lo, ord_hi;             // range of ord
+    vector<std::pair<int, int> > iv;  // iv[a*k + i]:  interval of
+                                    //   component a in labeling i
+    vector<std::pair<int, int> > tree;  // tree[a]:  range of post-order
+                                    //   numbers of a's DFS subtree in
+                                    //   labeling 0 (never widened)
+    int next_num;                   // first unused post-order number
+    std::mt19937 rng;
+    reach_stats st;
+
+    // search labels; valid only if seen[a] equals round (as in
+    //   graph::bidir_labels)
+    vector<unsigned> seen;
+    unsigned round;
+    vector<int> stk;
+
+    // true if every interval of a contains the matching one of b
+    bool contains(int a, int b) const {
+      const std::pair<int, int> *x = &iv[(size_t)a*k], *y = &iv[(size_t)b*k];
+      int i;
+
+      for(i=0; i<k; i++) {
+        if(y[i].first < x[i].first || y[i].second > x[i].second)
           return false;
       }
-      string s;
-      int u;
-      u = target;
-     
-      enum_path(u, s,paths);
-      
       return true;
     }
-    void enum_path(int V, string& s, vector<string>& paths)
-    {
-         
-        s = id2name(V) + " " + s;
-        string t = s;
-        if(vertices[V].incoming.size()==0)
-        {
-            paths.push_back(s);
-             return;
+
+    bool maybe(int a, int b) const {
+      return ord[a] < ord[b] && contains(a, b);
+    }
+
+    /*
+     * function:  label
+     * desc:  interval labeling i:  DFS from every root (component
+     *   without in-edges) in random order, visiting children from a
+     *   random starting point.  Iterative, like graph::_dfs.
+     */
+    void label(int i) {
+      vector<int> roots, start;
+      vector<char> visited;
+      vector<std::pair<int, int> > dfs;   // (component, children visited)
+      int a, b, nc = succ.size(), num = 0;
+
+      visited.assign(nc, 0);
+      start.resize(nc);
+      for(a=0; a<nc; a++) {
+        start[a] = succ[a].empty() ? 0 : rng() % succ[a].size();
+        iv[(size_t)a*k + i] = std::make_pair(INT_MAX, 0);
+        if(pred[a].empty())
+          roots.push_back(a);
+      }
+      std::shuffle(roots.begin(), roots.end(), rng);
+
+      for(int r : roots) {
+        visited[r] = 1;
+        if(i == 0)
+          tree[r].first = num;
+        dfs.push_back(std::make_pair(r, 0));
+        while(!dfs.empty()) {
+          a = dfs.back().first;
+          std::pair<int, int> &ia = iv[(size_t)a*k + i];
+          if(dfs.back().second == (int)succ[a].size()) {
+            ia.second = num++;
+            ia.first = std::min(ia.first, ia.second);
+            if(i == 0)
+              tree[a].second = ia.second;
+            dfs.pop_back();
+            if(!dfs.empty()) {
+              std::pair<int, int> &ip = iv[(size_t)dfs.back().first*k + i];
+              ip.first = std::min(ip.first, ia.first);
+            }
+            continue;
+          }
+          b = succ[a][(start[a] + dfs.back().second++) % succ[a].size()];
+          if(!visited[b]) {
+            visited[b] = 1;
+            if(i == 0)
+              tree[b].first = num;
+            dfs.push_back(std::make_pair(b, 0));
+          }
+          else
+            ia.first = std::min(ia.first, iv[(size_t)b*k + i].first);
         }
-        int v;
-        for (edge& e : vertices[V].incoming)
-        {
-            v = e.vertex_id;
-            enum_path(v, s, paths);
-            s = t;
+      }
+      next_num = std::max(next_num, num);
+    }
+
+    bool current() {
+      return n == g.num_nodes() && m == g.num_edges() &&
+        relabels == g._relabels;
+    }
+
+    // adds a component with no edges at the front (or back) of the
+    //   topological order
+    int new_component(bool front) {
+      int a = succ.size(), i;
+
+      succ.push_back(vector<int>());
+      pred.push_back(vector<int>());
+      seen.push_back(0);
+      ord.push_back(front ? --ord_lo : ++ord_hi);
+      tree.push_back(front ? std::make_pair(INT_MAX, INT_MIN) :
+          std::make_pair(next_num, next_num));
+      for(i=0; i<k; i++) {
+        if(front)
+          iv.push_back(std::make_pair(INT_MAX, INT_MIN));
+        else
+          iv.push_back(std::make_pair(next_num, next_num));
+      }
+      if(!front)
+        next_num++;
+      return a;
+    }
+
+    // does component a reach component b?
+    bool reach(int a, int b) {
+      int x;
+
+      if(a == b || (tree[a].first <= tree[b].second &&
+            tree[b].second <= tree[a].second))
+        return true;
+      if(!maybe(a, b))
+        return false;
+      st.searches++;
+      if(++round == 0) {
+        seen.assign(seen.size(), 0);
+        round = 1;
+      }
+      stk.assign(1, a);
+      seen[a] = round;
+      while(!stk.empty()) {
+        x = stk.back();
+        stk.pop_back();
+        for(int y : succ[x]) {
+          if(y == b)
+            return true;
+          if(seen[y] != round && maybe(y, b)) {
+            seen[y] = round;
+            stk.push_back(y);
+          }
+        }
+      }
+      return false;
+    }
+
+    // grows the intervals of a and its ancestors to contain b's
+    void extend(int a, int b) {
+      int x, i;
+      bool changed;
+
+      stk.assign(1, a);
+      while(!stk.empty()) {
+        x = stk.back();
+        stk.pop_back();
+        changed = false;
+        for(i=0; i<k; i++) {
+          std::pair<int, int> &ix = iv[(size_t)x*k + i];
+          const std::pair<int, int> &ib = iv[(size_t)b*k + i];
+          if(ib.first < ix.first) {
+            ix.first = ib.first;
+            changed = true;
+          }
+          if(ib.second > ix.second) {
+            ix.second = ib.second;
+            changed = true;
+          }
         }
+        // if x already contained b, so do its ancestors
+        if(changed)
+          stk.insert(stk.end(), pred[x].begin(), pred[x].end());
+      }
+    }
+
+    size_t memory() const {
+      size_t bytes = sizeof(*this);
+      size_t a;
+
+      bytes += comp.capacity()*sizeof(int) + ord.capacity()*sizeof(int) +
+        seen.capacity()*sizeof(unsigned) +
+        (iv.capacity() + tree.capacity())*sizeof(std::pair<int, int>);
+      for(a=0; a<succ.size(); a++)
+        bytes += 2*sizeof(vector<int>) +
+          (succ[a].capacity() + pred[a].capacity())*sizeof(int);
+      return bytes;
     }
 
+  public:
+    // nlabels:  number of interval labelings (more filter better but
+    //   cost memory and build time)
+    reach_index(graph &_g, int nlabels=4) : g { _g }, k { std::max(1, nlabels) },
+      n { -1 }, m { -1 }, relabels { 0 }, ord_lo { 0 }, ord_hi { -1 }, next_num { 0 },
+      rng { 12345 }, round { 0 } {
+      memset(&st, 0, sizeof(st));
+      build();
+    }
 
     /*
-     * (DONE)
-     * func: enum_paths(string, vector<string> &)
-     * desc: same as enum_paths(int, vector<string> &) above except
-     *       target vertex is taken as its name (as a string).
+     * func:  build
+     * desc:  (re)builds the index from scratch.
      *
-     *       Simply translates target vertex name to its integer id
-     *       and calls enum_paths(int, vector<string> &) above.
+     * RUNTIME:  O(k (V+E))
      */
-    bool enum_paths(const string &target,  vector<string> &paths) {
-      int tgt;
-      if((tgt=name2id(target)) == -1)
-          return false;
+    void build() {
+      auto start = std::chrono::steady_clock::now();
+      graph dag;
+      int a, i, nc;
+
+      g.condensation(dag, comp);
+      nc = dag.num_nodes();
+      const graph::csr &c = dag.snapshot();
+      succ.assign(nc, vector<int>());
+      pred.assign(nc, vector<int>());
+      ord.resize(nc);
+      for(a=0; a<nc; a++) {
+        succ[a].assign(c.out_tgt.begin() + c.out_off[a],
+            c.out_tgt.begin() + c.out_off[a+1]);
+        pred[a].assign(c.in_tgt.begin() + c.in_off[a],
+            c.in_tgt.begin() + c.in_off[a+1]);
+        ord[a] = a;   // condensation numbers components topologically
+      }
+      ord_lo = 0;
+      ord_hi = nc - 1;
+
+      iv.resize((size_t)nc*k);
+      tree.resize(nc);
+      next_num = 0;
+      for(i=0; i<k; i++)
+        label(i);
+
+      seen.assign(nc, 0);
+      round = 0;
+      n = g.num_nodes();
+      m = g.num_edges();
+      relabels = g._relabels;
+
+      st.components = nc;
+      st.dag_edges = c.out_tgt.size();
+      st.builds++;
+      st.build_ms = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start).count();
+      st.bytes = memory();
+    }
 
-      return enum_paths(tgt, paths);
+    /*
+     * func:  can_reach
+     * desc:  true if there is a path from u to v (every vertex reaches
+     *   itself).  Rebuilds the index first if the graph has changed
+     *   other than through add_edge.
+     *
+     * returns false if u or v is out of range.
+     */
+    bool can_reach(int u, int v) {
+      if(!current())
+        build();
+      if(u < 0 || u >= n || v < 0 || v >= n)
+        return false;
+      st.queries++;
+      return reach(comp[u], comp[v]);
     }
-    
 
+    bool can_reach(const string &u, const string &v) {
+      return can_reach(g.name2id(u), g.name2id(v));
+    }
 
+    /*
+     * func:  add_edge
+     * desc:  adds edge (src,dest) to the graph (see graph::add_edge)
+     *   and updates the index.
+     *
+     *   In place, in time proportional to the ancestors whose
+     *   intervals grow, when src already reaches dest or src comes
+     *   before dest in the index's topological order -- which includes
+     *   every edge that adds a new vertex.  Otherwise (the edge may
+     *   close a cycle) the index is rebuilt.
+     *
+     * returns the result of graph::add_edge.
+     */
+    bool add_edge(const string &src, const string &dest, double weight=1.0) {
+      int x, y, a, b;
+      bool stale = !current();
 
-};
+      if(!g.add_edge(src, dest, weight))
+        return false;
+      if(stale) {
+        build();
+        return true;
+      }
+
+      // new vertices are numbered in the order add_edge added them
+      x = g.name2id(src);
+      y = g.name2id(dest);
+      if(x >= (int)comp.size())
+        comp.push_back(new_component(true));
+      if(y >= (int)comp.size())
+        comp.push_back(new_component(false));
+      n = g.num_nodes();
+      m = g.num_edges();
+
+      a = comp[x];
+      b = comp[y];
+      if(reach(a, b)) {
+        // reachability is unchanged
+        st.incremental++;
+        return true;
+      }
+      if(ord[a] > ord[b]) {
+        build();
+        return true;
+      }
+      succ[a].push_back(b);
+      pred[b].push_back(a);
+      extend(a, b);
+      st.incremental++;
+      st.dag_edges++;
+      st.components = succ.size();
+      st.bytes = memory();
+      return true;
+    }
 
+    const reach_stats & stats() const {
+      return st;
+    }
+};
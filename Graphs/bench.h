@@ -0,0 +1,71 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <tuple>
+#include "Graph.h"
+
+
+// helpers shared by the bench_* programs:  timing, the edge lists
+//   they generate, and checking that two graphs came out the same.
+
+inline double seconds_since(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+// (source, destination, weight), what graph::add_edges takes
+typedef std::tuple<string, string, double> edge_spec;
+
+// the edges of a side x side grid with vertices named "row,col":  from
+//   each vertex to its right and lower neighbors, and back again if
+//   both_ways.
+inline std::vector<std::pair<string, string> > grid_edges(int side, bool both_ways) {
+  std::vector<std::pair<string, string> > edges;
+  int r, c;
+  string a;
+
+  for(r=0; r<side; r++) {
+    for(c=0; c<side; c++) {
+      a = std::to_string(r) + "," + std::to_string(c);
+      if(c+1 < side) {
+        edges.push_back(std::make_pair(a, std::to_string(r) + "," + std::to_string(c+1)));
+        if(both_ways)
+          edges.push_back(std::make_pair(edges.back().second, a));
+      }
+      if(r+1 < side) {
+        edges.push_back(std::make_pair(a, std::to_string(r+1) + "," + std::to_string(c)));
+        if(both_ways)
+          edges.push_back(std::make_pair(edges.back().second, a));
+      }
+    }
+  }
+  return edges;
+}
+
+// same edges, comparing vertices by name:  same degrees and same
+//   distances from src.  a may also have vertices with no edges that
+//   b does not have (b built from edges, a from removing some).
+inline bool same_graph(graph &a, graph &b, const string &src) {
+  std::vector<graph::vertex_label> ra, rb;
+  int u, v, matched = 0;
+
+  if(a.num_edges() != b.num_edges())
+    return false;
+  a.dijkstra(a.name2id(src), ra);
+  b.dijkstra(b.name2id(src), rb);
+  for(u=0; u<a.num_nodes(); u++) {
+    v = b.name2id(a.id2name(u));
+    if(v == -1) {
+      if(a.out_degree(u) + a.in_degree(u) != 0)
+        return false;
+    }
+    else if(a.out_degree(u) != b.out_degree(v) ||
+        a.in_degree(u) != b.in_degree(v) || ra[u].dist != rb[v].dist)
+      return false;
+    else
+      matched++;
+  }
+  return matched == b.num_nodes();
+}
+
+#endif
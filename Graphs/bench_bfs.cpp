@@ -0,0 +1,103 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for the multi-threaded bfs (graph::bfs_par).
+//
+// builds an R-MAT random graph (skewed degrees, small diameter --
+//   roughly what social and dependency graphs look like) with
+//   2^scale vertices and edgefactor*2^scale edges, then times
+//   bfs and bfs_par with 1, 2, 4, ... threads from the same sources,
+//   checking that every run produces the same dist and npaths.
+
+void rmat_graph(graph &g, int scale, int edgefactor, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  long long e, m = (long long)edgefactor << scale;
+  int bit, src, dest;
+  double r;
+
+  for(e=0; e<m; e++) {
+    src = dest = 0;
+    for(bit=0; bit<scale; bit++) {
+      r = coin(rng);
+      // quadrant probabilities a=.57, b=.19, c=.19, d=.05
+      if(r < 0.57) ;
+      else if(r < 0.76) dest |= 1 << bit;
+      else if(r < 0.95) src |= 1 << bit;
+      else { src |= 1 << bit; dest |= 1 << bit; }
+    }
+    g.add_edge(std::to_string(src), std::to_string(dest));
+  }
+}
+
+bool same_labels(const std::vector<graph::vertex_label> &a,
+    const std::vector<graph::vertex_label> &b) {
+  for(size_t u=0; u<a.size(); u++) {
+    if(a[u].dist != b[u].dist || a[u].npaths != b[u].npaths)
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]){
+  graph g;
+  int scale = argc > 1 ? atoi(argv[1]) : 18;
+  int edgefactor = argc > 2 ? atoi(argv[2]) : 16;
+  int nsrc = argc > 3 ? atoi(argv[3]) : 8;
+  int maxthreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<graph::vertex_label> seq_rpt, par_rpt;
+  std::vector<int> sources;
+  double t_seq, t;
+  int i, k, nthreads;
+
+  if(argc > 4) {
+    std::cout << "usage:  ./bench_bfs [scale] [edgefactor] [num-sources]\n";
+    return 0;
+  }
+
+  // duplicate R-MAT edges are expected; don't report them
+  std::cerr.setstate(std::ios::failbit);
+  rmat_graph(g, scale, edgefactor, 1);
+  std::cerr.clear();
+  g.freeze();
+
+  std::cout << "R-MAT graph: " << g.num_nodes() << " vertices, " <<
+    g.num_edges() << " edges; " << nsrc << " sources\n\n";
+
+  // sources:  vertices with outgoing edges, spread over the ID range
+  for(i=0; (int)sources.size()<nsrc && i<g.num_nodes(); i+=std::max(1, g.num_nodes()/nsrc/4)) {
+    if(g.out_degree(i) > 0)
+      sources.push_back(i);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for(int s : sources)
+    g.bfs(s, seq_rpt);
+  t_seq = seconds_since(start);
+  std::cout << "  bfs (sequential)    " << t_seq/sources.size()*1000 << " ms/search\n";
+
+  for(nthreads=1; nthreads<=maxthreads; nthreads*=2) {
+    bool ok = true;
+
+    g.bfs_par(sources[0], par_rpt, nthreads);   // start the threads
+    t = 0;
+    for(k=0; k<(int)sources.size(); k++) {
+      start = std::chrono::steady_clock::now();
+      g.bfs_par(sources[k], par_rpt, nthreads);
+      t += seconds_since(start);
+      g.bfs(sources[k], seq_rpt);
+      ok = ok && same_labels(seq_rpt, par_rpt);
+    }
+    std::cout << "  bfs_par " << nthreads << " thread(s)  " <<
+      t/sources.size()*1000 << " ms/search   speedup " << t_seq/t <<
+      (ok ? "" : "   MISMATCH!") << "\n";
+    if(nthreads < maxthreads && 2*nthreads > maxthreads)
+      nthreads = maxthreads/2;
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,77 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for bulk edge insertion (graph::add_edges).
+//
+// generates m random edges (with about 1% repeated) over n named
+//   vertices and times loading them with add_edge one at a time
+//   against add_edges with one thread and with all of them, checking
+//   that all three graphs come out the same.
+
+// same vertex IDs (names in the same order) as well as the same edges
+bool same_ids(graph &a, graph &b) {
+  if(a.num_nodes() != b.num_nodes())
+    return false;
+  for(int u=0; u<a.num_nodes(); u++) {
+    if(a.id2name(u) != b.id2name(u))
+      return false;
+  }
+  return same_graph(a, b, a.id2name(0));
+}
+
+int main(int argc, char *argv[]){
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  int m = argc > 2 ? atoi(argv[2]) : 8000000;
+  std::vector<edge_spec> batch;
+  std::mt19937 rng(1);
+  int i, added[3];
+  double t[3];
+
+  if(argc > 3) {
+    std::cout << "usage:  ./bench_bulk [num-vertices] [num-edges]\n";
+    return 0;
+  }
+
+  batch.reserve(m);
+  for(i=0; i<m; i++) {
+    if(i > 0 && rng() % 100 == 0)
+      batch.push_back(batch[rng() % i]);
+    else
+      batch.push_back(edge_spec("v" + std::to_string(rng() % n),
+            "v" + std::to_string(rng() % n), 1 + rng() % 100));
+  }
+  std::cout << m << " edges over up to " << n << " vertices\n\n";
+
+  // (duplicate warnings are not interesting here)
+  std::cerr.setstate(std::ios::failbit);
+
+  graph g0;
+  auto start = std::chrono::steady_clock::now();
+  added[0] = 0;
+  for(edge_spec &e : batch)
+    added[0] += g0.add_edge(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+  t[0] = seconds_since(start);
+
+  graph g1;
+  start = std::chrono::steady_clock::now();
+  added[1] = g1.add_edges(batch.begin(), batch.end(), 1);
+  t[1] = seconds_since(start);
+
+  graph g2;
+  start = std::chrono::steady_clock::now();
+  added[2] = g2.add_edges(batch);
+  t[2] = seconds_since(start);
+
+  std::cerr.clear();
+  std::cout << "  add_edge loop:          " << t[0]*1000 << " ms  (" << added[0] << " edges added)\n";
+  std::cout << "  add_edges, 1 thread:    " << t[1]*1000 << " ms  (" << t[0]/t[1] << "x)\n";
+  std::cout << "  add_edges, all threads: " << t[2]*1000 << " ms  (" << t[0]/t[2] << "x)\n";
+
+  if(added[1] != added[0] || added[2] != added[0] || !same_ids(g0, g1) ||
+      !same_ids(g0, g2))
+    std::cout << "\nMISMATCH!\n";
+  return 0;
+}
@@ -0,0 +1,103 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for compressed adjacency (graph::compress).
+//
+// builds a side x side grid DAG (edges go right and down, weights
+//   1..100), adding the edges in a random order, and reports the
+//   memory per edge and the bfs/dfs/topo_sort times of the graph as
+//   built, frozen, compressed, and compressed after an rcm reorder.
+//   Distances and the topological order are checked against the
+//   uncompressed graph.
+
+void grid_dag(graph &g, int side, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::pair<string, string> > edges = grid_edges(side, false);
+
+  std::shuffle(edges.begin(), edges.end(), rng);
+  for(auto &e : edges)
+    g.add_edge(e.first, e.second, 1 + rng() % 100);
+}
+
+void run(graph &g, const char *name, const std::vector<int> &sources,
+    std::vector<std::vector<graph::vertex_label> > &expect) {
+  std::vector<graph::vertex_label> rpt, orig;
+  std::vector<int> to_new(g.num_nodes()), order;
+  double tb = 0, td = 0, tt, bytes = g.bytes_per_edge();
+  bool ok = true, cycle;
+  size_t k, u;
+
+  for(u=0; u<to_new.size(); u++)
+    to_new[g.orig_id(u)] = u;
+  for(k=0; k<sources.size(); k++) {
+    auto start = std::chrono::steady_clock::now();
+    g.bfs(to_new[sources[k]], rpt);
+    tb += seconds_since(start);
+    g.to_original(rpt, orig);
+    if(expect.size() <= k)
+      expect.push_back(orig);
+    for(u=0; u<orig.size(); u++)
+      ok = ok && orig[u].dist == expect[k][u].dist;
+
+    start = std::chrono::steady_clock::now();
+    g.dfs(to_new[sources[k]], rpt, cycle);
+    td += seconds_since(start);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  ok = g.topo_sort(order) && ok;
+  tt = seconds_since(start);
+  // (valid_topo_order uncompresses a compressed graph, with a warning
+  //   that is not interesting here)
+  std::cerr.setstate(std::ios::failbit);
+  ok = ok && g.valid_topo_order(order);
+  std::cerr.clear();
+
+  std::cout << "  " << name << "  " << bytes << " bytes/edge   bfs " <<
+    tb/sources.size()*1000 << " ms   dfs " << td/sources.size()*1000 <<
+    " ms   topo_sort " << tt*1000 << " ms" << (ok ? "" : "   MISMATCH!") << "\n";
+}
+
+int main(int argc, char *argv[]){
+  graph g;
+  int side = argc > 1 ? atoi(argv[1]) : 1000;
+  int nsrc = argc > 2 ? atoi(argv[2]) : 5;
+  std::vector<int> sources, new_id;
+  std::vector<std::vector<graph::vertex_label> > expect;
+  std::mt19937 rng(2);
+
+  if(argc > 3) {
+    std::cout << "usage:  ./bench_compress [grid-side] [num-sources]\n";
+    return 0;
+  }
+
+  grid_dag(g, side, 1);
+  std::cout << "grid DAG: " << g.num_nodes() << " vertices, " << g.num_edges() <<
+    " edges (added in random order); " << nsrc << " sources\n\n";
+  while((int)sources.size() < nsrc)
+    sources.push_back(rng() % g.num_nodes());
+
+  // each run starts from a copy of g, since topo_sort caches its
+  //   answer in the graph
+  graph h = g;
+  run(h, "as built  ", sources, expect);
+
+  h = g;
+  h.freeze();
+  run(h, "frozen    ", sources, expect);
+
+  h = g;
+  h.compress();
+  run(h, "compressed", sources, expect);
+
+  h = g;
+  h.rcm_order(new_id);
+  h.compress();
+  h.reorder(new_id);
+  run(h, "rcm + comp", sources, expect);
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <unistd.h>
+#include "bench.h"
+
+
+// benchmark for vertex-name storage (name_arena).
+//
+// First, n path-like names ("lib/module_17/file_123456.cpp") are
+//   stored both in a name_arena and in the representation the graph
+//   used before it -- a vector<string> of names plus an
+//   unordered_map<string, int> from names to IDs -- and the memory
+//   (growth of the resident set) and insert/lookup times are compared.
+//
+// Then a graph with those names as vertices is loaded from an edge
+//   list (read_file) and from its binary form (read_binary), and the
+//   load times and name memory are reported.
+
+size_t rss_bytes() {
+  std::ifstream f("/proc/self/statm");
+  size_t pages = 0, resident = 0;
+
+  f >> pages >> resident;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+string make_name(int i) {
+  return "lib/module_" + std::to_string(i % 1000) + "/file_" +
+    std::to_string(i) + ".cpp";
+}
+
+int main(int argc, char *argv[]){
+  int n = argc > 1 ? atoi(argv[1]) : 2000000;
+  int i, id;
+  long long sum = 0;
+  size_t before;
+  bool added;
+  std::mt19937 rng(1);
+
+  if(argc > 2) {
+    std::cout << "usage:  ./bench_names [num-names]\n";
+    return 0;
+  }
+
+  vector<string> names;
+  for(i=0; i<n; i++)
+    names.push_back(make_name(i));
+  std::shuffle(names.begin(), names.end(), rng);
+  std::cout << n << " names\n\n";
+
+  // (the arena goes first:  its few large blocks are handed back to
+  //   the system when it is freed, so they don't hide the growth of
+  //   the string version)
+  {
+    name_arena a;
+    before = rss_bytes();
+    auto start = std::chrono::steady_clock::now();
+    for(i=0; i<n; i++)
+      a.insert(names[i].data(), names[i].size(), added);
+    double ti = seconds_since(start);
+    size_t mem = rss_bytes() - before;
+
+    start = std::chrono::steady_clock::now();
+    for(i=n-1; i>=0; i--)
+      sum += a.find(names[i].data(), names[i].size());
+    double tl = seconds_since(start);
+    std::cout << "  name_arena:              " << (double)mem/n << " bytes/name   insert " <<
+      ti*1000 << " ms   lookup " << tl*1000 << " ms\n";
+  }
+  {
+    vector<string> id2name;
+    unordered_map<string, int> name2id;
+    before = rss_bytes();
+    auto start = std::chrono::steady_clock::now();
+    for(i=0; i<n; i++) {
+      auto res = name2id.emplace(names[i], (int)id2name.size());
+      if(res.second)
+        id2name.push_back(names[i]);
+    }
+    double ti = seconds_since(start);
+    size_t mem = rss_bytes() - before;
+
+    start = std::chrono::steady_clock::now();
+    for(i=n-1; i>=0; i--) {
+      auto it = name2id.find(names[i]);
+      sum += it == name2id.end() ? -1 : it->second;
+    }
+    double tl = seconds_since(start);
+    std::cout << "  vector + unordered_map:  " << (double)mem/n << " bytes/name   insert " <<
+      ti*1000 << " ms   lookup " << tl*1000 << " ms\n";
+  }
+
+  // a graph over the names:  a chain plus random "dependencies"
+  {
+    string fname = "bench_names.txt", bname = "bench_names.bin";
+    std::ofstream f(fname);
+    for(i=0; i+1<n; i++) {
+      f << names[i] << " " << names[i+1] << "\n";
+      f << names[i] << " " << names[rng() % n] << "\n";
+    }
+    f.close();
+
+    graph g;
+    auto start = std::chrono::steady_clock::now();
+    g.read_file(fname);
+    double tr = seconds_since(start);
+    g.write_binary(bname);
+
+    graph h;
+    start = std::chrono::steady_clock::now();
+    h.read_binary(bname);
+    double tb = seconds_since(start);
+
+    for(id=0; id<g.num_nodes(); id+=997)
+      sum += h.name2id(g.id2name(id)) != id;
+    std::cout << "\n  graph: " << g.num_nodes() << " vertices, " << g.num_edges() <<
+      " edges;  names " << (double)g.name_bytes()/g.num_nodes() << " bytes/vertex\n" <<
+      "    read_file " << tr*1000 << " ms   read_binary " << tb*1000 << " ms\n";
+    std::remove(fname.c_str());
+    std::remove(bname.c_str());
+  }
+  std::cout << "\n(checksum " << sum << ")\n";
+  return 0;
+}
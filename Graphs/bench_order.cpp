@@ -0,0 +1,119 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for the vertex orderings (graph::reorder).
+//
+// builds a side x side grid with two-way edges -- the kind of graph
+//   where neighbors are naturally "close" -- but adds its edges in a
+//   random order, so vertex IDs (first-seen order) are scattered.
+//   Then, for the original numbering and for each ordering, reports
+//   the average ID gap across an edge and times bfs and dfs from the
+//   same sources, checking (through to_original) that bfs gives the
+//   same distances.
+
+void grid_graph(graph &g, int side, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::pair<string, string> > edges = grid_edges(side, true);
+
+  std::shuffle(edges.begin(), edges.end(), rng);
+  for(auto &e : edges)
+    g.add_edge(e.first, e.second);
+}
+
+// average |u - v| over the edges (u,v)
+double avg_gap(graph &g) {
+  std::vector<graph::vertex_label> rpt;
+  double sum = 0;
+  int u, v, n = g.num_nodes();
+
+  // a bfs from every vertex would be too slow; use the neighbor
+  //   relation through a dfs tree instead:  gap between each vertex
+  //   and its dfs predecessor
+  bool cycle;
+  g.dfs(0, rpt, cycle);
+  for(v=0; v<n; v++) {
+    u = rpt[v].pred;
+    if(u != -1)
+      sum += std::abs(u - v);
+  }
+  return sum / n;
+}
+
+void run(graph &g, const char *name, const std::vector<int> &sources,
+    std::vector<std::vector<graph::vertex_label> > &expect, double base[2]) {
+  std::vector<graph::vertex_label> rpt, orig;
+  std::vector<int> to_new(g.num_nodes());
+  double tb = 0, td = 0;
+  bool ok = true, cycle;
+  size_t k, u;
+
+  for(u=0; u<to_new.size(); u++)
+    to_new[g.orig_id(u)] = u;
+  for(k=0; k<sources.size(); k++) {
+    auto start = std::chrono::steady_clock::now();
+    g.bfs(to_new[sources[k]], rpt);
+    tb += seconds_since(start);
+    g.to_original(rpt, orig);
+    if(expect.size() <= k)
+      expect.push_back(orig);
+    for(u=0; u<orig.size(); u++)
+      ok = ok && orig[u].dist == expect[k][u].dist;
+
+    start = std::chrono::steady_clock::now();
+    g.dfs(to_new[sources[k]], rpt, cycle);
+    td += seconds_since(start);
+  }
+  tb /= sources.size();
+  td /= sources.size();
+  if(base[0] == 0) {
+    base[0] = tb;
+    base[1] = td;
+  }
+  std::cout << "  " << name << "  gap " << avg_gap(g) << "   bfs " << tb*1000 <<
+    " ms (" << base[0]/tb << "x)   dfs " << td*1000 << " ms (" << base[1]/td <<
+    "x)" << (ok ? "" : "   MISMATCH!") << "\n";
+}
+
+int main(int argc, char *argv[]){
+  graph g;
+  int side = argc > 1 ? atoi(argv[1]) : 700;
+  int nsrc = argc > 2 ? atoi(argv[2]) : 5;
+  std::vector<int> sources, new_id;
+  std::vector<std::vector<graph::vertex_label> > expect;
+  double base[2] = { 0, 0 };
+  std::mt19937 rng(2);
+
+  if(argc > 3) {
+    std::cout << "usage:  ./bench_order [grid-side] [num-sources]\n";
+    return 0;
+  }
+
+  grid_graph(g, side, 1);
+  g.freeze();
+  std::cout << "grid: " << g.num_nodes() << " vertices, " << g.num_edges() <<
+    " edges (added in random order); " << nsrc << " sources\n\n";
+  while((int)sources.size() < nsrc)
+    sources.push_back(rng() % g.num_nodes());
+
+  run(g, "original", sources, expect, base);
+
+  graph h = g;
+  h.degree_order(new_id);
+  h.reorder(new_id);
+  run(h, "degree  ", sources, expect, base);
+
+  h = g;
+  h.bfs_order(new_id);
+  h.reorder(new_id);
+  run(h, "bfs     ", sources, expect, base);
+
+  h = g;
+  h.rcm_order(new_id);
+  h.reorder(new_id);
+  run(h, "rcm     ", sources, expect, base);
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for path counting (graph::dag_num_paths) with each counter
+//   type.
+//
+// builds a layered DAG:  depth layers of width vertices, each vertex
+//   with deg edges from random vertices of the layer before.  Path
+//   counts grow like deg^depth, so uint64_t wraps around after a few
+//   dozen layers.  Then times dag_num_paths with uint64_t,
+//   sat_count128, mod_count_m61 and log_count, and checks the wider
+//   counts against each other (and log_count against them) where they
+//   are exact.
+
+void layered_dag(graph &g, int width, int depth, int deg, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<edge_spec> edges;
+  int l, u, j;
+
+  for(l=1; l<depth; l++) {
+    for(u=0; u<width; u++) {
+      for(j=0; j<deg; j++)
+        edges.push_back(edge_spec(
+              "L" + std::to_string(l-1) + "." + std::to_string(rng() % width),
+              "L" + std::to_string(l) + "." + std::to_string(u), 1.0));
+    }
+  }
+  g.add_edges(edges);
+}
+
+// seconds per dag_num_paths call, best of reps
+template <typename C>
+double time_paths(graph &g, std::vector<C> &npaths, int reps) {
+  double t, best = 1e30;
+
+  for(int r=0; r<reps; r++) {
+    auto start = std::chrono::steady_clock::now();
+    g.dag_num_paths(npaths);
+    t = seconds_since(start);
+    best = std::min(best, t);
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]){
+  graph g;
+  int width = argc > 1 ? atoi(argv[1]) : 1000;
+  int depth = argc > 2 ? atoi(argv[2]) : 200;
+  int deg = argc > 3 ? atoi(argv[3]) : 4;
+  int reps = 5;
+  std::vector<uint64_t> c64;
+  std::vector<sat_count128> c128;
+  std::vector<mod_count_m61> cmod;
+  std::vector<log_count> clog;
+  double t64, t128, tmod, tlog;
+  bool ok = true;
+  int u, nsat = 0;
+
+  if(argc > 4) {
+    std::cout << "usage:  ./bench_paths [width] [depth] [in-degree]\n";
+    return 0;
+  }
+
+  // (duplicate warnings are not interesting here)
+  std::cerr.setstate(std::ios::failbit);
+  layered_dag(g, width, depth, deg, 1);
+  std::cerr.clear();
+  std::cout << "layered DAG: " << g.num_nodes() << " vertices, " <<
+    g.num_edges() << " edges, " << depth << " layers\n\n";
+  g.dag_num_paths(c64);     // topological order and snapshot
+
+  t64 = time_paths(g, c64, reps);
+  t128 = time_paths(g, c128, reps);
+  tmod = time_paths(g, cmod, reps);
+  tlog = time_paths(g, clog, reps);
+
+  for(u=0; u<g.num_nodes(); u++) {
+    if(c128[u].saturated()) {
+      nsat++;
+      continue;
+    }
+    ok = ok && (uint64_t)c128[u].v == c64[u] &&
+      c128[u].v % ((1ULL << 61) - 1) == cmod[u].v &&
+      std::fabs(clog[u].l - std::log((double)c128[u].v)) <= 1e-9 * std::max(1.0, clog[u].l);
+  }
+
+  std::cout << "  uint64_t       " << t64*1000 << " ms\n";
+  std::cout << "  sat_count128   " << t128*1000 << " ms  (" << t128/t64 << "x)\n";
+  std::cout << "  mod_count_m61  " << tmod*1000 << " ms  (" << tmod/t64 << "x)\n";
+  std::cout << "  log_count      " << tlog*1000 << " ms  (" << tlog/t64 << "x)\n";
+  std::cout << "\n  " << nsat << " of " << g.num_nodes() <<
+    " vertices saturated in 128 bits" << (ok ? "" : "   MISMATCH!") << "\n";
+  return 0;
+}
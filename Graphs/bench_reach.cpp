@@ -0,0 +1,97 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for reach_index.
+//
+// builds a dependency-like graph:  n "packages", each depending on a
+//   few earlier ones (mostly recent ones), plus a handful of back
+//   edges that create cycles.  Then answers random can_reach queries
+//   with the index, checking a sample against bfs, and adds more
+//   edges through the index to time incremental updates.
+
+void deps_graph(graph &g, int n, int deg, int ncycles, unsigned seed) {
+  std::mt19937 rng(seed);
+  int u, j, v;
+
+  for(u=1; u<n; u++) {
+    for(j=0; j<deg; j++) {
+      // half of the dependencies are on nearby packages
+      v = (j % 2 == 0) ? u - 1 - rng() % std::min(u, 50) : rng() % u;
+      g.add_edge("p" + std::to_string(u), "p" + std::to_string(v));
+    }
+  }
+  for(j=0; j<ncycles; j++) {
+    u = rng() % (n-10);
+    g.add_edge("p" + std::to_string(u), "p" + std::to_string(u + 1 + rng() % 10));
+  }
+}
+
+int main(int argc, char *argv[]){
+  graph g;
+  int n = argc > 1 ? atoi(argv[1]) : 100000;
+  int nq = argc > 2 ? atoi(argv[2]) : 1000000;
+  int nadd = argc > 3 ? atoi(argv[3]) : 1000;
+  std::mt19937 rng(7);
+  std::vector<graph::vertex_label> rpt;
+  long long yes = 0;
+  bool ok = true;
+  int i, u, v;
+
+  if(argc > 4) {
+    std::cout << "usage:  ./bench_reach [num-vertices] [num-queries] [num-added-edges]\n";
+    return 0;
+  }
+
+  deps_graph(g, n, 3, 20, 1);
+  std::cout << "dependency graph: " << g.num_nodes() << " vertices, " <<
+    g.num_edges() << " edges\n\n";
+
+  reach_index ri(g);
+  const reach_index::reach_stats &st = ri.stats();
+  std::cout << "index: " << st.components << " components, " << st.dag_edges <<
+    " DAG edges, " << st.bytes/1024 << " KB, built in " << st.build_ms << " ms\n";
+
+  auto start = std::chrono::steady_clock::now();
+  for(i=0; i<nq; i++)
+    yes += ri.can_reach((int)(rng() % n), (int)(rng() % n));
+  double t = seconds_since(start);
+  std::cout << "can_reach: " << t/nq*1e6 << " us/query (" << yes << " true, " <<
+    st.searches << " of " << st.queries << " needed a search)\n";
+
+  t = 0;
+  for(i=0; i<20; i++) {
+    u = rng() % n;
+    start = std::chrono::steady_clock::now();
+    g.bfs(u, rpt);
+    t += seconds_since(start);
+    for(v=0; v<n; v++)
+      ok = ok && ri.can_reach(u, v) == (rpt[v].dist != -1);
+  }
+  std::cout << "bfs: " << t/20*1000 << " ms/query" <<
+    (ok ? "" : "   MISMATCH!") << "\n";
+
+  start = std::chrono::steady_clock::now();
+  for(i=0; i<nadd; i++) {
+    u = rng() % (n + 100);
+    v = rng() % (n + 100);
+    if(u > v)
+      std::swap(u, v);
+    ri.add_edge("p" + std::to_string(v), "p" + std::to_string(u));
+  }
+  std::cout << "\nadd_edge: " << seconds_since(start)/nadd*1e6 << " us/edge (" <<
+    st.incremental << " in place, " << st.builds-1 << " rebuilds)\n";
+
+  for(i=0; i<20; i++) {
+    u = rng() % g.num_nodes();
+    g.bfs(u, rpt);
+    for(v=0; v<g.num_nodes(); v++)
+      ok = ok && ri.can_reach(u, v) == (rpt[v].dist != -1);
+  }
+  std::cout << "index: " << st.components << " components, " << st.dag_edges <<
+    " DAG edges, " << st.bytes/1024 << " KB" << (ok ? "" : "   MISMATCH!") << "\n";
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <set>
+#include "bench.h"
+
+
+// benchmark for edge and vertex removal (graph::remove_edge,
+//   remove_vertex and compact).
+//
+// builds a graph of m random edges over n named vertices, then removes
+//   10% of the edges and 5% of the vertices one at a time and times
+//   that against what it replaces:  building the graph again from the
+//   edges that are left.  Also times bfs before and after the removals
+//   and checks that the two graphs come out the same.
+
+double time_bfs(graph &g, const string &src) {
+  std::vector<graph::vertex_label> rpt;
+  auto start = std::chrono::steady_clock::now();
+
+  g.bfs(src, rpt);
+  return seconds_since(start);
+}
+
+int main(int argc, char *argv[]){
+  int n = argc > 1 ? atoi(argv[1]) : 200000;
+  int m = argc > 2 ? atoi(argv[2]) : 2000000;
+  std::vector<edge_spec> batch, left;
+  std::set<std::pair<string, string> > gone_edge;
+  std::vector<char> gone_vtx(n, 0);
+  std::vector<int> pick;
+  std::mt19937 rng(1);
+  int i, nrm_edges, nrm_vtx, renumberings = 0;
+  double t_edges, t_vtx, t_compact, t_rebuild, t_bfs[3];
+
+  if(argc > 3) {
+    std::cout << "usage:  ./bench_remove [num-vertices] [num-edges]\n";
+    return 0;
+  }
+
+  for(i=0; i<m; i++)
+    batch.push_back(edge_spec("v" + std::to_string(rng() % n),
+          "v" + std::to_string(rng() % n), 1 + rng() % 100));
+  std::cout << m << " edges over up to " << n << " vertices\n\n";
+
+  // (duplicate warnings are not interesting here)
+  std::cerr.setstate(std::ios::failbit);
+  graph g;
+  g.add_edges(batch);
+  g.on_compact([&](const std::vector<int> &/*new_id*/) { renumberings++; });
+  t_bfs[0] = time_bfs(g, "v0");
+
+  // 10% of the edges, then 5% of the vertices (never v0)
+  for(i=0; i<m; i++)
+    pick.push_back(i);
+  std::shuffle(pick.begin(), pick.end(), rng);
+  nrm_edges = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(i=0; i<m/10; i++) {
+    edge_spec &e = batch[pick[i]];
+    if(g.remove_edge(std::get<0>(e), std::get<1>(e))) {
+      gone_edge.insert(std::make_pair(std::get<0>(e), std::get<1>(e)));
+      nrm_edges++;
+    }
+  }
+  t_edges = seconds_since(start);
+
+  nrm_vtx = 0;
+  start = std::chrono::steady_clock::now();
+  for(i=0; i<n/20; i++) {
+    int v = 1 + rng() % (n-1);
+    if(g.remove_vertex("v" + std::to_string(v))) {
+      gone_vtx[v] = 1;
+      nrm_vtx++;
+    }
+  }
+  t_vtx = seconds_since(start);
+
+  t_bfs[1] = time_bfs(g, "v0");     // includes rebuilding the snapshot
+  t_bfs[2] = time_bfs(g, "v0");
+
+  start = std::chrono::steady_clock::now();
+  g.compact();
+  t_compact = seconds_since(start);
+
+  // what removal replaces:  a new graph from the edges that are left
+  for(i=0; i<m; i++) {
+    edge_spec &e = batch[i];
+    if(!gone_edge.count(std::make_pair(std::get<0>(e), std::get<1>(e))) &&
+        !gone_vtx[atoi(std::get<0>(e).c_str()+1)] &&
+        !gone_vtx[atoi(std::get<1>(e).c_str()+1)])
+      left.push_back(e);
+  }
+  graph h;
+  start = std::chrono::steady_clock::now();
+  h.add_edges(left);
+  t_rebuild = seconds_since(start);
+  std::cerr.clear();
+
+  std::cout << "  remove_edge:   " << nrm_edges << " edges in " << t_edges*1000
+    << " ms  (" << t_edges*1e6/nrm_edges << " us each)\n";
+  std::cout << "  remove_vertex: " << nrm_vtx << " vertices in " << t_vtx*1000
+    << " ms  (" << t_vtx*1e6/nrm_vtx << " us each)\n";
+  std::cout << "  compactions that renumbered vertices:  " << renumberings << "\n";
+  std::cout << "  compact() at the end:  " << t_compact*1000 << " ms\n";
+  std::cout << "  rebuild from the edges left:  " << t_rebuild*1000 << " ms\n\n";
+  std::cout << "  bfs before removals:             " << t_bfs[0]*1000 << " ms\n";
+  std::cout << "  bfs after (rebuilds snapshot):   " << t_bfs[1]*1000 << " ms\n";
+  std::cout << "  bfs after, again:                " << t_bfs[2]*1000 << " ms\n";
+
+  std::cerr.setstate(std::ios::failbit);
+  if(!same_graph(g, h, "v0"))
+    std::cout << "\nMISMATCH!\n";
+  return 0;
+}
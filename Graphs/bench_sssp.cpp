@@ -0,0 +1,224 @@
+
+#include <iostream>
+#include <random>
+#include "bench.h"
+
+
+// benchmark for the priority queues of graph::dijkstra.
+//
+// builds a "road-like" graph:  a side x side grid of intersections
+//   with two-way streets between neighbors, a few streets missing,
+//   and integer travel times (1..100).  Then runs dijkstra from the
+//   same sources with each priority queue, checking that the
+//   distances agree.  Then delta_stepping is timed with 1, 2, 4, ...
+//   threads, up to the number of hardware threads.  Last, point-to-point
+//   queries from the same sources to random targets are timed with
+//   bidir_dijkstra, bidir_bfs, an alt_index with num-landmarks
+//   landmarks and a ch_index, and checked against dijkstra and bfs.  The "settled"
+//   count of plain dijkstra is what it would settle if it stopped at
+//   the target:  the vertices no farther than the target.
+
+// weights of the edges road_graph added, keyed by "src dest"
+std::map<string, int> weight;
+
+void road_graph(graph &g, int side, unsigned seed) {
+  std::mt19937 rng(seed);
+  int r, c, w;
+  string a, b;
+
+  for(r=0; r<side; r++) {
+    for(c=0; c<side; c++) {
+      a = std::to_string(r) + "," + std::to_string(c);
+      if(c+1 < side && rng() % 10 != 0) {
+        b = std::to_string(r) + "," + std::to_string(c+1);
+        w = 1 + rng() % 100;
+        g.add_edge(a, b, w);
+        g.add_edge(b, a, w);
+        weight[a + " " + b] = weight[b + " " + a] = w;
+      }
+      if(r+1 < side && rng() % 10 != 0) {
+        b = std::to_string(r+1) + "," + std::to_string(c);
+        w = 1 + rng() % 100;
+        g.add_edge(a, b, w);
+        g.add_edge(b, a, w);
+        weight[a + " " + b] = weight[b + " " + a] = w;
+      }
+    }
+  }
+}
+
+// true if path is a path of g of length len
+bool valid_path(graph &g, const std::vector<int> &path, double len) {
+  double sum = 0;
+  size_t i;
+
+  for(i=0; i+1<path.size(); i++) {
+    auto e = weight.find(g.id2name(path[i]) + " " + g.id2name(path[i+1]));
+    if(e == weight.end())
+      return false;
+    sum += e->second;
+  }
+  return sum == len;
+}
+
+template <typename PQ>
+void run(graph &g, const char *name, const std::vector<int> &sources,
+    std::vector<std::vector<graph::vertex_label> > &expect) {
+  std::vector<graph::vertex_label> rpt;
+  bool ok = true;
+  double t = 0;
+  size_t k, u;
+
+  for(k=0; k<sources.size(); k++) {
+    auto start = std::chrono::steady_clock::now();
+    g.dijkstra<PQ>(sources[k], rpt);
+    t += seconds_since(start);
+    if(expect.size() <= k)
+      expect.push_back(rpt);
+    for(u=0; u<rpt.size(); u++)
+      ok = ok && rpt[u].dist == expect[k][u].dist &&
+        rpt[u].npaths == expect[k][u].npaths;
+  }
+  std::cout << "  " << name << "  " << t/sources.size()*1000 << " ms/query" <<
+    (ok ? "" : "   MISMATCH!") << "\n";
+}
+
+int main(int argc, char *argv[]){
+  graph g;
+  int side = argc > 1 ? atoi(argv[1]) : 500;
+  int nsrc = argc > 2 ? atoi(argv[2]) : 5;
+  int nlm = argc > 3 ? atoi(argv[3]) : 16;
+  std::vector<int> sources;
+  std::vector<std::vector<graph::vertex_label> > expect;
+  std::mt19937 rng(2);
+
+  if(argc > 4) {
+    std::cout << "usage:  ./bench_sssp [grid-side] [num-sources] [num-landmarks]\n";
+    return 0;
+  }
+
+  road_graph(g, side, 1);
+  g.freeze();
+  std::cout << "road-like grid: " << g.num_nodes() << " vertices, " <<
+    g.num_edges() << " edges; " << nsrc << " sources\n\n";
+
+  while((int)sources.size() < nsrc)
+    sources.push_back(rng() % g.num_nodes());
+
+  run<binary_heap>(g, "binary_heap ", sources, expect);
+  run<pairing_heap>(g, "pairing_heap", sources, expect);
+  run<radix_heap>(g, "radix_heap  ", sources, expect);
+
+
+  unsigned nt, hw = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<graph::vertex_label> rpt;
+  std::cout << "\ndelta_stepping (delta " << g.delta_stepping_auto() << ")\n";
+  for(nt=1; ; nt*=2) {
+    bool ok = true;
+    double t = 0;
+    nt = std::min(nt, hw);
+    for(size_t k=0; k<sources.size(); k++) {
+      auto start = std::chrono::steady_clock::now();
+      g.delta_stepping(sources[k], rpt, 0, nt);
+      t += seconds_since(start);
+      for(size_t u=0; u<rpt.size(); u++)
+        ok = ok && rpt[u].dist == expect[k][u].dist &&
+          rpt[u].npaths == expect[k][u].npaths;
+    }
+    std::cout << "  " << nt << " thread(s)  " << t/sources.size()*1000 <<
+      " ms/query" << (ok ? "" : "   MISMATCH!") << "\n";
+    if(nt == hw)
+      break;
+  }
+
+  alt_index alt(g);
+  auto start = std::chrono::steady_clock::now();
+  alt.build(nlm);
+  double tbuild = seconds_since(start);
+  bool okio = alt.write("bench_sssp.alt") && alt.read("bench_sssp.alt");
+  std::remove("bench_sssp.alt");
+
+  ch_index ch(g);
+  start = std::chrono::steady_clock::now();
+  ch.build();
+  double tch = seconds_since(start);
+  okio = okio && ch.write("bench_sssp.ch") && ch.read("bench_sssp.ch");
+  std::remove("bench_sssp.ch");
+
+  std::vector<int> path;
+  std::vector<graph::vertex_label> hops;
+  double len, tw = 0, tu = 0, ta = 0, tc = 0;
+  long long settled, nsettled = 0, asettled = 0, dsettled = 0, csettled = 0;
+  bool okw = true, oku = true, oka = true, okc = true;
+  size_t k, u;
+  int dest;
+  for(k=0; k<sources.size(); k++) {
+    dest = rng() % g.num_nodes();
+    start = std::chrono::steady_clock::now();
+    bool found = g.bidir_dijkstra(sources[k], dest, path, &len, &settled);
+    tw += seconds_since(start);
+    nsettled += settled;
+    if(found)
+      okw = okw && len == expect[k][dest].dist && path.front() == sources[k] &&
+        path.back() == dest;
+    else
+      okw = okw && expect[k][dest].dist == -1;
+
+    start = std::chrono::steady_clock::now();
+    found = alt.query(sources[k], dest, path, &len, &settled);
+    ta += seconds_since(start);
+    asettled += settled;
+    if(found)
+      oka = oka && len == expect[k][dest].dist && path.front() == sources[k] &&
+        path.back() == dest;
+    else
+      oka = oka && expect[k][dest].dist == -1;
+
+    start = std::chrono::steady_clock::now();
+    found = ch.query(sources[k], dest, path, &len, &settled);
+    tc += seconds_since(start);
+    csettled += settled;
+    if(found)
+      okc = okc && len == expect[k][dest].dist && valid_path(g, path, len) &&
+        path.front() == sources[k] && path.back() == dest;
+    else
+      okc = okc && expect[k][dest].dist == -1;
+
+    for(u=0; u<expect[k].size(); u++) {
+      if(expect[k][u].dist != -1 && (expect[k][dest].dist == -1 ||
+            expect[k][u].dist <= expect[k][dest].dist))
+        dsettled++;
+    }
+
+    g.bfs(sources[k], hops);
+    start = std::chrono::steady_clock::now();
+    found = g.bidir_bfs(sources[k], dest, path);
+    tu += seconds_since(start);
+    if(found)
+      oku = oku && path.size()-1 == hops[dest].dist;
+    else
+      oku = oku && hops[dest].dist == -1;
+  }
+  std::cout << "\npoint-to-point\n";
+  std::cout << "  dijkstra        " << dsettled/(long long)sources.size() <<
+    " settled/query\n";
+  std::cout << "  bidir_dijkstra  " << tw/sources.size()*1000 << " ms/query, " <<
+    nsettled/(long long)sources.size() << " settled/query" <<
+    (okw ? "" : "   MISMATCH!") << "\n";
+  std::cout << "  bidir_bfs       " << tu/sources.size()*1000 << " ms/query" <<
+    (oku ? "" : "   MISMATCH!") << "\n";
+  std::cout << "  alt_index       " << ta/sources.size()*1000 << " ms/query, " <<
+    asettled/(long long)sources.size() << " settled/query" <<
+    (oka ? "" : "   MISMATCH!") << "   (" << alt.num_landmarks() <<
+    " landmarks, built in " << tbuild << " s" <<
+    ")\n";
+  std::cout << "  ch_index        " << tc/sources.size()*1000 << " ms/query, " <<
+    csettled/(long long)sources.size() << " settled/query" <<
+    (okc ? "" : "   MISMATCH!") << "   (" << ch.num_arcs() <<
+    " arcs, built in " << tch << " s)\n";
+  if(!okio)
+    std::cout << "  write/read FAILED\n";
+
+  return 0;
+}
+
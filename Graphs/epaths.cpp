@@ -4,12 +4,26 @@
 
 
 // program exercising the enum_paths function
+//
+// paths are streamed to the output as they are found (they are not
+//   collected first), so this works even when there are too many
+//   paths to keep in memory.  An optional third argument stops the
+//   listing after that many paths.
 
 int main(int argc, char *argv[]){
   graph g;
-
-  if(argc != 3) {
-    std::cout << "usage:  ./epaths <filename> <destination-vertex>\n";
+  long long limit = -1;
+  bool usage = argc != 3 && argc != 4;
+  char *end;
+
+  // max-paths must be a positive integer
+  if(argc == 4) {
+    errno = 0;
+    limit = strtoll(argv[3], &end, 10);
+    usage = end == argv[3] || *end != '\0' || errno == ERANGE || limit <= 0;
+  }
+  if(usage) {
+    std::cout << "usage:  ./epaths <filename> <destination-vertex> [max-paths]\n";
     return 0;
   }
   else {
@@ -25,15 +39,13 @@ int main(int argc, char *argv[]){
   std::cout << "\nEND ADJACENCY LIST:\n\n";
   */
 
-  vector<string> paths;
-
-  if(!g.enum_paths(argv[2], paths)) {
+  if(g.has_cycle() || g.name2id(argv[2]) == -1) {
     std::cout << "enum_paths failed  - cycle?\n" ;
     return 0;
   }
   else {
     std::cout << "\nINPUT PATHS ENDING AT " << argv[2] << " :\n\n";
-    pvec(paths);
+    g.enum_paths(argv[2], std::cout, limit);
   }
 
   return 0;
@@ -0,0 +1,29 @@
+
+#include <iostream>
+#include "Graph.h"
+
+
+// converts a graph from the text edge-list format to the binary
+//   graph format (see graph::write_binary)
+
+int main(int argc, char *argv[]){
+  graph g;
+
+  if(argc != 3) {
+    std::cout << "usage:  ./gconv <text-file> <binary-file>\n";
+    return 0;
+  }
+  if(!g.read_file(argv[1])){
+    std::cout << "could not open file '" << argv[1] << "'\n";
+    return 0;
+  }
+  if(!g.write_binary(argv[2])){
+    std::cout << "could not write file '" << argv[2] << "'\n";
+    return 0;
+  }
+  std::cout << "wrote " << g.num_nodes() << " vertices and " <<
+    g.num_edges() << " edges to '" << argv[2] << "'\n";
+
+  return 0;
+}
+
@@ -18,12 +18,32 @@ int main(int argc, char *argv[]){
   std::cout << "\nADJACENCY-LIST REPRESENTATION:\n\n";
   g.display();
 
-  if(g.topo_sort(id_order)) 
+  if(g.topo_sort(id_order)) {
     std::cout << "topo sort succeeded!\n";
-  else 
-    std::cout << "topo sort failed (cycle?)!\n";
+    g.ids2names(id_order, name_order);
+  }
+  else {
+    graph dag;
+    std::vector<int> comp;
+    std::vector<std::vector<string> > members;
 
-  g.ids2names(id_order, name_order);
+    std::cout << "topo sort failed (cycle?)!\n";
+    g.condensation(dag, comp);
+    members.resize(dag.num_nodes());
+    for(int u=0; u<g.num_nodes(); u++)
+      members[comp[u]].push_back(g.id2name(u));
+
+    std::cout << "\nstrongly connected components with cycles:\n\n";
+    for(size_t k=0; k<members.size(); k++) {
+      if(members[k].size() > 1)
+        std::cout << "  " << g.name_vec2string(members[k]) << "\n";
+    }
+
+    // each component is named after one of its vertices
+    std::cout << "\nsorting the components instead\n";
+    dag.topo_sort(id_order);
+    dag.ids2names(id_order, name_order);
+  }
 
   std::cout << "here is the topological order produced:\n\n";
 